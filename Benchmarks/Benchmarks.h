@@ -0,0 +1,10 @@
+#pragma once
+
+#include <filesystem>
+
+// benchmarks that can only be registered at run time, see main.cpp
+
+// one per Instruction::Enum handler, Dxyn for each sprite height
+void RegisterInstructionBenchmarks();
+// one per ROM in romsPath and execution mode (interpreter, superinstructions, jit)
+void RegisterRomBenchmarks(const std::filesystem::path& romsPath);
@@ -0,0 +1,229 @@
+#include "Benchmarks.h"
+
+#include "Emulator/Chip8.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+
+namespace
+{
+	struct BenchmarkChip8 final: public emu::Chip8
+	{
+		// no fetch and no dispatch: the cost of the handler alone
+		using emu::Chip8::CycleStatic;
+		// no fetch: the cost of the handler and of the dispatch
+		using emu::Chip8::ExecuteInstruction;
+	};
+
+	// instructions executed before pc is moved back to programStart, so that pc += 2 doesn't run off the ram
+	constexpr std::size_t batchSize = 256;
+	constexpr emu::TwoBytes programStart = 0x200;
+	constexpr emu::TwoBytes dataStart = 0x800;
+	constexpr emu::Byte pressedKey = 5;
+
+	// V0 = 0, V1 = pressedKey, V2 = 3, I = dataStart, which holds a 16 rows sprite
+	void Initialize(BenchmarkChip8& chip8)
+	{
+		chip8.GetRng().Seed(0);
+
+		for (unsigned int x = 0; x < 16; ++x)
+		{
+			const auto value = x * 0x11u;
+			chip8.CycleStatic<emu::Instruction::_0x6xkk>(static_cast<emu::TwoBytes>(0x6000u | (x << 8u) | value));
+		}
+		chip8.CycleStatic<emu::Instruction::_0xAnnn>(0xA000 | dataStart);
+		chip8.CycleStatic<emu::Instruction::_0xFx55>(0xFF55);
+
+		chip8.CycleStatic<emu::Instruction::_0x6xkk>(0x6000);
+		chip8.CycleStatic<emu::Instruction::_0x6xkk>(0x6100 | pressedKey);
+		chip8.CycleStatic<emu::Instruction::_0x6xkk>(0x6203);
+		chip8.GetKeypad().Press(static_cast<emu::Keys::Enum>(pressedKey), true);
+		chip8.CycleStatic<emu::Instruction::_0x1nnn>(0x1000 | programStart);
+	}
+
+	// x = 1, y = 2 and I stays put, so that every run of the batch does the same work
+	constexpr emu::TwoBytes MakeInstruction(const emu::Instruction::Enum instructionCode)
+	{
+		switch (instructionCode)
+		{
+			case emu::Instruction::_0x00E0:
+				return 0x00E0;
+			case emu::Instruction::_0x00EE:
+				return 0x00EE;
+			case emu::Instruction::_0x1nnn:
+				return 0x1000 | programStart;
+			case emu::Instruction::_0x2nnn:
+				return 0x2000 | programStart;
+			case emu::Instruction::_0x3xkk:
+				return 0x3100 | pressedKey;
+			case emu::Instruction::_0x4xkk:
+				return 0x4100 | pressedKey;
+			case emu::Instruction::_0x5xy0:
+				return 0x5120;
+			case emu::Instruction::_0x6xkk:
+				return 0x6100 | pressedKey;
+			case emu::Instruction::_0x7xkk:
+				return 0x7101;
+			case emu::Instruction::_0x8xy0:
+				return 0x8120;
+			case emu::Instruction::_0x8xy1:
+				return 0x8121;
+			case emu::Instruction::_0x8xy2:
+				return 0x8122;
+			case emu::Instruction::_0x8xy3:
+				return 0x8123;
+			case emu::Instruction::_0x8xy4:
+				return 0x8124;
+			case emu::Instruction::_0x8xy5:
+				return 0x8125;
+			case emu::Instruction::_0x8xy6:
+				return 0x8126;
+			case emu::Instruction::_0x8xy7:
+				return 0x8127;
+			case emu::Instruction::_0x8xyE:
+				return 0x812E;
+			case emu::Instruction::_0x9xy0:
+				return 0x9120;
+			case emu::Instruction::_0xAnnn:
+				return 0xA000 | dataStart;
+			case emu::Instruction::_0xBnnn:
+				return 0xB000 | programStart;
+			case emu::Instruction::_0xCxkk:
+				return 0xC1FF;
+			case emu::Instruction::_0xDxyn:
+				return 0xD120;
+			case emu::Instruction::_0xExA1:
+				return 0xE1A1;
+			case emu::Instruction::_0xEx9E:
+				return 0xE19E;
+			case emu::Instruction::_0xFx07:
+				return 0xF107;
+			case emu::Instruction::_0xFx0A:
+				return 0xF10A;
+			case emu::Instruction::_0xFx15:
+				return 0xF115;
+			case emu::Instruction::_0xFx18:
+				return 0xF118;
+			case emu::Instruction::_0xFx1E:
+				// V0 = 0
+				return 0xF01E;
+			case emu::Instruction::_0xFx29:
+				return 0xF129;
+			case emu::Instruction::_0xFx33:
+				return 0xF133;
+			case emu::Instruction::_0xFx55:
+				return 0xF155;
+			case emu::Instruction::_0xFx65:
+				return 0xF165;
+			default:
+				return 0x0000;
+		}
+	}
+
+	// Dxyn takes the sprite height as argument
+	template<emu::Instruction::Enum instructionCode>
+	void BM_Instruction(benchmark::State& state)
+	{
+		BenchmarkChip8 chip8;
+		Initialize(chip8);
+		auto instruction = MakeInstruction(instructionCode);
+		if constexpr (instructionCode == emu::Instruction::_0xDxyn)
+			instruction = static_cast<emu::TwoBytes>(instruction | state.range(0));
+
+		for (auto _ : state)
+		{
+			for (std::size_t i = 0; i < batchSize; ++i)
+			{
+				chip8.CycleStatic<instructionCode>(instruction);
+
+				// 16 levels of stack only: every call is paired with its return
+				if constexpr (instructionCode == emu::Instruction::_0x2nnn)
+					chip8.CycleStatic<emu::Instruction::_0x00EE>(MakeInstruction(emu::Instruction::_0x00EE));
+			}
+			chip8.CycleStatic<emu::Instruction::_0x1nnn>(0x1000 | programStart);
+		}
+
+		if (!chip8.IsValid())
+			state.SkipWithError(std::string(emu::ToString(chip8.GetLastError())).c_str());
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batchSize));
+	}
+
+	// as BM_Instruction<Instruction::_0x8xy4>, with the dispatch through the handlers table
+	void BM_DispatchSingle(benchmark::State& state)
+	{
+		BenchmarkChip8 chip8;
+		Initialize(chip8);
+		const auto instruction = MakeInstruction(emu::Instruction::_0x8xy4);
+		for (auto _ : state)
+		{
+			for (std::size_t i = 0; i < batchSize; ++i)
+				chip8.ExecuteInstruction(instruction);
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batchSize));
+	}
+	BENCHMARK(BM_DispatchSingle)->Name("Dispatch/Single");
+
+	// as BM_DispatchSingle, with a random mix of instructions that the branch predictor can't learn
+	void BM_DispatchMixed(benchmark::State& state)
+	{
+		// no control flow, no memory writes and no font lookups, which are valid for any register value
+		static constexpr std::array<emu::Instruction::Enum, 17> instructionCodes = { {
+			emu::Instruction::_0x6xkk,
+			emu::Instruction::_0x7xkk,
+			emu::Instruction::_0x8xy0,
+			emu::Instruction::_0x8xy1,
+			emu::Instruction::_0x8xy2,
+			emu::Instruction::_0x8xy3,
+			emu::Instruction::_0x8xy4,
+			emu::Instruction::_0x8xy5,
+			emu::Instruction::_0x8xy6,
+			emu::Instruction::_0x8xy7,
+			emu::Instruction::_0x8xyE,
+			emu::Instruction::_0xAnnn,
+			emu::Instruction::_0xCxkk,
+			emu::Instruction::_0xFx07,
+			emu::Instruction::_0xFx15,
+			emu::Instruction::_0xFx18,
+			emu::Instruction::_0xFx1E,
+		} };
+
+		std::mt19937 generator(0);
+		std::uniform_int_distribution<std::size_t> distribution(0, instructionCodes.size() - 1);
+		std::array<emu::TwoBytes, batchSize> instructions {};
+		for (auto& instruction : instructions)
+			instruction = MakeInstruction(instructionCodes[distribution(generator)]);
+
+		BenchmarkChip8 chip8;
+		Initialize(chip8);
+		for (auto _ : state)
+		{
+			for (const auto instruction : instructions)
+				chip8.ExecuteInstruction(instruction);
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batchSize));
+	}
+	BENCHMARK(BM_DispatchMixed)->Name("Dispatch/Mixed");
+}	 // namespace
+
+void RegisterInstructionBenchmarks()
+{
+	utils::ConstexprFor<0, emu::Instruction::END>(
+		[](const auto i)
+		{
+			constexpr auto instructionCode = static_cast<emu::Instruction::Enum>(i.value);
+			// see BM_Instruction<Instruction::_0x2nnn>
+			if constexpr (instructionCode == emu::Instruction::_0x00EE)
+				return;
+
+			auto name = "Instruction/" + std::string(emu::ToString(instructionCode));
+			if constexpr (instructionCode == emu::Instruction::_0x2nnn)
+				name += "+" + std::string(emu::ToString(emu::Instruction::_0x00EE));
+
+			auto* benchmark = benchmark::RegisterBenchmark(name.c_str(), &BM_Instruction<instructionCode>);
+			if constexpr (instructionCode == emu::Instruction::_0xDxyn)
+				benchmark->DenseRange(1, 15)->ArgName("height");
+		});
+}
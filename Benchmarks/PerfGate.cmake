@@ -0,0 +1,30 @@
+# runs the ROM benchmarks and compares them against the baseline, see Tools/PerfGate.cpp
+# cmake -DBENCHMARKS=<chip8-benchmarks> -DPERF_GATE=<chip8-perf-gate> -DBASELINE=<file> -DRESULTS=<file>
+#       -DPRESET=<name> -DTOLERANCE=<fraction> -DREPETITIONS=<n> [-DUPDATE=ON] -P PerfGate.cmake
+
+execute_process(
+	COMMAND
+		${BENCHMARKS} --benchmark_filter=^Rom/ --benchmark_repetitions=${REPETITIONS}
+		--benchmark_report_aggregates_only=true --benchmark_out=${RESULTS} --benchmark_out_format=json
+	RESULT_VARIABLE
+		result
+)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "chip8-benchmarks failed (${result})")
+endif()
+
+if (UPDATE)
+	set(gateArguments --update)
+else()
+	set(gateArguments --tolerance ${TOLERANCE})
+endif()
+
+execute_process(
+	COMMAND
+		${PERF_GATE} --baseline ${BASELINE} --results ${RESULTS} --preset ${PRESET} ${gateArguments}
+	RESULT_VARIABLE
+		result
+)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "performance regression: see the table above, or ${RESULTS}")
+endif()
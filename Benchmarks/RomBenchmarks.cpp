@@ -0,0 +1,100 @@
+#include "Benchmarks.h"
+
+#include "Emulator/Chip8.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+	namespace Mode
+	{
+		enum Enum
+		{
+			START = 0,
+			Interpreter = START,
+			Superinstructions,
+			Jit,
+			END,
+		};
+	}	 // namespace Mode
+
+	constexpr std::string_view ToString(const Mode::Enum mode)
+	{
+		switch (mode)
+		{
+			case Mode::Interpreter:
+				return "Interpreter";
+			case Mode::Superinstructions:
+				return "Superinstructions";
+			case Mode::Jit:
+				return "Jit";
+			default:
+				return "?";
+		}
+	}
+
+	// instructions per benchmark iteration: each iteration starts from a freshly loaded ROM
+	constexpr std::size_t romCycles = 1'000'000;
+
+	void BM_Rom(benchmark::State& state, const std::filesystem::path& rom, const Mode::Enum mode)
+	{
+		emu::Chip8 chip8;
+		if (mode == Mode::Jit && !emu::Jit::IsSupported())
+		{
+			state.SkipWithError("jit not supported on this platform");
+			return;
+		}
+
+		std::size_t cycles = 0;
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			if (!chip8.LoadRom(rom))
+			{
+				state.SkipWithError(("couldn't load " + rom.string()).c_str());
+				break;
+			}
+			chip8.GetRng().Seed(0);
+			chip8.SetSuperinstructionsEnabled(mode == Mode::Superinstructions);
+			chip8.SetJitEnabled(mode == Mode::Jit);
+			state.ResumeTiming();
+
+			cycles += chip8.RunCyclesThroughKeyWaits(romCycles).cycles;
+			if (!chip8.IsValid())
+			{
+				state.SkipWithError(std::string(emu::ToString(chip8.GetLastError())).c_str());
+				break;
+			}
+		}
+
+		// the throughput to track across presets, under a name that doesn't depend on SetItemsProcessed
+		state.counters["cycles_per_second"] =
+			benchmark::Counter(static_cast<double>(cycles), benchmark::Counter::kIsRate);
+		state.SetItemsProcessed(static_cast<std::int64_t>(cycles));
+	}
+}	 // namespace
+
+void RegisterRomBenchmarks(const std::filesystem::path& romsPath)
+{
+	std::vector<std::filesystem::path> roms;
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(romsPath, ec))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".ch8")
+			roms.push_back(entry.path());
+	}
+	// stable names and order, to be compared across runs
+	std::sort(roms.begin(), roms.end());
+
+	for (const auto& rom : roms)
+	{
+		for (auto mode = Mode::START; mode < Mode::END; mode = static_cast<Mode::Enum>(mode + 1))
+		{
+			const auto name = "Rom/" + rom.stem().string() + "/" + std::string(ToString(mode));
+			benchmark::RegisterBenchmark(name.c_str(), &BM_Rom, rom, mode)->Unit(benchmark::kMillisecond);
+		}
+	}
+}
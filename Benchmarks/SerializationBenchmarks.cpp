@@ -0,0 +1,57 @@
+#include "Emulator/Chip8.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+namespace
+{
+	// what the rewind history and the save states go through
+	void BM_Serialize(benchmark::State& state)
+	{
+		emu::Chip8 chip8;
+		chip8.GetRng().Seed(0);
+		std::vector<emu::Byte> byteArray;
+		for (auto _ : state)
+		{
+			byteArray.clear();
+			chip8.Serialize(byteArray);
+			benchmark::DoNotOptimize(byteArray.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(byteArray.size()));
+	}
+	BENCHMARK(BM_Serialize)->Name("Serialization/Serialize");
+
+	void BM_Deserialize(benchmark::State& state)
+	{
+		emu::Chip8 chip8;
+		chip8.GetRng().Seed(0);
+		std::vector<emu::Byte> byteArray;
+		chip8.Serialize(byteArray);
+		for (auto _ : state)
+		{
+			chip8.Deserialize(byteArray);
+			benchmark::ClobberMemory();
+		}
+
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(byteArray.size()));
+	}
+	BENCHMARK(BM_Deserialize)->Name("Serialization/Deserialize");
+
+	void BM_RoundTrip(benchmark::State& state)
+	{
+		emu::Chip8 chip8;
+		chip8.GetRng().Seed(0);
+		std::vector<emu::Byte> byteArray;
+		for (auto _ : state)
+		{
+			byteArray.clear();
+			chip8.Serialize(byteArray);
+			chip8.Deserialize(byteArray);
+			benchmark::ClobberMemory();
+		}
+
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(byteArray.size()));
+	}
+	BENCHMARK(BM_RoundTrip)->Name("Serialization/RoundTrip");
+}	 // namespace
@@ -0,0 +1,30 @@
+#include "Benchmarks.h"
+
+#include "Emulator/Logging.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+
+/*
+ * chip8-benchmarks: google benchmark suite, e.g.
+ *   chip8-benchmarks --benchmark_filter=Rom/ --benchmark_out=benchmarks.json --benchmark_out_format=json
+ * ROMS_PATH overrides the folder the ROM benchmarks are taken from (Roms/ by default).
+ * */
+int main(int argc, char** argv)
+{
+	// logging would dominate the timings
+	spdlog::set_level(spdlog::level::off);
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	const auto* romsPath = std::getenv("ROMS_PATH");
+	RegisterInstructionBenchmarks();
+	RegisterRomBenchmarks(romsPath != nullptr ? romsPath : CHIP8_ROMS_PATH);
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Logging.h"
+#include "MpscQueue.h"
+
+__START_IGNORING_WARNINGS__
+__IGNORE_SPDLOG_WARNINGS__
+#include "spdlog/pattern_formatter.h"
+__STOP_IGNORING_WARNINGS__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace utils::detail
+{
+	// a log record as it was when logged: fixed size, so that logging neither allocates nor formats
+	struct LogSlot
+	{
+		static constexpr std::size_t maxLoggerNameSize = 32;
+		static constexpr std::size_t maxPayloadSize = 256;
+
+		spdlog::log_clock::time_point time {};
+		spdlog::source_loc source {};
+		std::size_t threadId = 0;
+		spdlog::level::level_enum level = spdlog::level::off;
+		std::uint8_t loggerNameSize = 0;
+		std::uint16_t payloadSize = 0;
+		std::array<char, maxLoggerNameSize> loggerName {};
+		std::array<char, maxPayloadSize> payload {};
+	};
+}	 // namespace utils::detail
+
+namespace utils
+{
+	/*
+	 * Sink where the logging threads only copy the record into a preallocated slot of a lock-free queue: a background
+	 * thread formats it into the last ringBufferSize lines. Records are dropped when the queue is full, and payloads
+	 * longer than LogSlot::maxPayloadSize are truncated, both counted.
+	 * */
+#ifdef __clang__
+	__START_IGNORING_WARNINGS__
+	__IGNORE_SPDLOG_WARNINGS__
+#endif
+	class AsyncRingBufferSink final: public spdlog::sinks::sink
+#ifdef __clang__
+		__STOP_IGNORING_WARNINGS__
+#endif
+	{
+	public:
+		static constexpr std::size_t queueSize = 1024;
+		static constexpr std::size_t ringBufferSize = 64;
+		using Line = std::pair<spdlog::level::level_enum, std::string>;
+
+		AsyncRingBufferSink() : _formatterThread([this] { FormatterLoop(); }) {}
+		AsyncRingBufferSink(const AsyncRingBufferSink&) = delete;
+		AsyncRingBufferSink& operator=(const AsyncRingBufferSink&) = delete;
+
+		// whatever has been logged is formatted before returning
+		~AsyncRingBufferSink() override
+		{
+			_running.store(false, std::memory_order_release);
+			_formatterThread.join();
+		}
+
+		void log(const spdlog::details::log_msg& msg) override
+		{
+			detail::LogSlot slot;
+			slot.time = msg.time;
+			slot.source = msg.source;
+			slot.threadId = msg.thread_id;
+			slot.level = msg.level;
+
+			slot.loggerNameSize =
+				static_cast<std::uint8_t>(std::min(msg.logger_name.size(), detail::LogSlot::maxLoggerNameSize));
+			std::copy_n(msg.logger_name.data(), slot.loggerNameSize, slot.loggerName.begin());
+
+			if (msg.payload.size() > detail::LogSlot::maxPayloadSize)
+				_nTruncated.fetch_add(1, std::memory_order_relaxed);
+			slot.payloadSize =
+				static_cast<std::uint16_t>(std::min(msg.payload.size(), detail::LogSlot::maxPayloadSize));
+			std::copy_n(msg.payload.data(), slot.payloadSize, slot.payload.begin());
+
+			if (!_queue.TryPush(slot))
+				_nDropped.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// waits for the formatter thread to catch up with everything logged so far
+		void flush() override
+		{
+			while (!_queue.Empty() || _formatting.load(std::memory_order_acquire))
+				std::this_thread::yield();
+		}
+
+		void set_pattern(const std::string& pattern) override
+		{
+			set_formatter(std::make_unique<spdlog::pattern_formatter>(pattern));
+		}
+		void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override
+		{
+			std::lock_guard<std::mutex> lock(_formatterMutex);
+			_formatter = std::move(formatter);
+		}
+
+		// a consistent copy of the last ringBufferSize lines, oldest first
+		void GetSnapshot(std::vector<Line>& lines) const
+		{
+			std::lock_guard<std::mutex> lock(_linesMutex);
+			lines.resize(_lines.Size());
+			for (std::size_t i = 0; i < _lines.Size(); ++i)
+				lines[i] = _lines[i];
+		}
+		void Clear()
+		{
+			std::lock_guard<std::mutex> lock(_linesMutex);
+			_lines.Clear();
+		}
+
+		[[nodiscard]] std::size_t GetFormattedCount() const { return _nFormatted.load(std::memory_order_relaxed); }
+		[[nodiscard]] std::size_t GetDroppedCount() const { return _nDropped.load(std::memory_order_relaxed); }
+		[[nodiscard]] std::size_t GetTruncatedCount() const { return _nTruncated.load(std::memory_order_relaxed); }
+
+	private:
+		void FormatterLoop()
+		{
+			static constexpr auto idleSleep = std::chrono::milliseconds(1);
+
+			detail::LogSlot slot;
+			while (true)
+			{
+				// set before popping, so that flush() can't see an empty queue while a record is being formatted
+				_formatting.store(true, std::memory_order_release);
+				std::size_t nFormatted = 0;
+				for (; _queue.TryPop(slot); ++nFormatted)
+					Format(slot);
+				_formatting.store(false, std::memory_order_release);
+
+				// drains the queue before stopping
+				if (nFormatted == 0)
+				{
+					if (!_running.load(std::memory_order_acquire) && _queue.Empty())
+						return;
+					std::this_thread::sleep_for(idleSleep);
+				}
+			}
+		}
+
+		void Format(const detail::LogSlot& slot)
+		{
+			spdlog::details::log_msg msg(slot.time, slot.source,
+										 spdlog::string_view_t(slot.loggerName.data(), slot.loggerNameSize),
+										 slot.level, spdlog::string_view_t(slot.payload.data(), slot.payloadSize));
+			msg.thread_id = slot.threadId;
+
+			_formatted.clear();
+			{
+				std::lock_guard<std::mutex> lock(_formatterMutex);
+				_formatter->format(msg, _formatted);
+			}
+
+			auto line = std::make_pair(slot.level, std::string(_formatted.data(), _formatted.size()));
+			{
+				std::lock_guard<std::mutex> lock(_linesMutex);
+				_lines.Add(std::move(line));
+			}
+			_nFormatted.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		MpscQueue<detail::LogSlot, queueSize> _queue {};
+		std::atomic<std::size_t> _nDropped { 0 };
+		std::atomic<std::size_t> _nTruncated { 0 };
+
+		// formatter thread only, besides set_formatter
+		std::mutex _formatterMutex {};
+		std::unique_ptr<spdlog::formatter> _formatter { std::make_unique<spdlog::pattern_formatter>() };
+		spdlog::memory_buf_t _formatted {};
+		std::atomic<std::size_t> _nFormatted { 0 };
+
+		mutable std::mutex _linesMutex {};
+		RingBuffer<Line, ringBufferSize> _lines {};
+
+		std::atomic<bool> _formatting { false };
+		std::atomic<bool> _running { true };
+		// last, so that everything it uses has been initialized when it starts
+		std::thread _formatterThread;
+	};
+}	 // namespace utils
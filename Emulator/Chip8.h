@@ -8,11 +8,27 @@
 #include "Rng.h"
 
 #include "Error.h"
+#include "RunResult.h"
 
+#include "DecodeTable.h"
+#include "Jit.h"
+#include "Superinstructions.h"
 #include "InstructionSet.h"
+#include "Profiler.h"
+#include "SamplingProfiler.h"
+#include "Trace.h"
 
+#include <array>
+#include <bitset>
+#include <chrono>
 #include <filesystem>
-#include <functional>
+#include <memory>
+
+// direct-threaded dispatch relies on labels-as-values, a GNU extension supported by both gcc and clang. It bypasses
+// ExecuteInstruction, where the profiler hooks in
+#if defined(CHIP8_THREADED_DISPATCH) && defined(__GNUC__) && !defined(CHIP8_PROFILER)
+	#define CHIP8_USE_THREADED_DISPATCH
+#endif
 
 // https://austinmorlan.com/posts/chip8_emulator/
 namespace emu
@@ -26,7 +42,40 @@ namespace emu
 			Chip8();
 			bool LoadRom(const std::filesystem::path& path);
 
+			// the instruction at pc or, with superinstructions enabled, the whole superinstruction starting there
 			bool Cycle();
+
+			// batched execution: runs up to nCycles instructions in a tight loop, stopping early only on errors,
+			// breakpoints, Fx0A waiting for a key and, if requested, on Dxyn/00E0
+			RunResult RunCycles(const std::size_t nCycles, const bool stopOnDisplayChange = false);
+			// as RunCycles, carrying on through Fx0A (replayed, and counted, until a key is pressed): a game waiting
+			// for a key still runs its timers
+			RunResult RunCyclesThroughKeyWaits(const std::size_t nCycles, const bool stopOnDisplayChange = false);
+			// GetCyclesPerFrame() cycles, i.e. a 60Hz frame worth
+			RunResult RunFrame(const bool stopOnDisplayChange = false);
+			// wall-clock pacing: runs the instructions due after elapsed seconds of real time (the fraction of an
+			// instruction is carried over to the next call), replaying Fx0A so that the timers keep running
+			RunResult RunFor(const std::chrono::duration<double> elapsed, const bool stopOnDisplayChange = false);
+			// as RunCycles, also stopping as soon as predicate(const Chip8&) is true after an instruction
+			template<typename Predicate>
+			RunResult RunUntil(Predicate&& predicate, const std::size_t maxCycles,
+							   const bool stopOnDisplayChange = false);
+
+			// clock model: the timers tick at timerFrequency every instructionsPerSecond / timerFrequency instructions,
+			// however the instructions are batched. timerFrequency instructions per second is one tick per instruction
+			static constexpr std::size_t timerFrequency = 60;
+			void SetInstructionsPerSecond(const std::size_t instructionsPerSecond);
+			[[nodiscard]] auto GetInstructionsPerSecond() const { return _instructionsPerSecond; }
+			[[nodiscard]] std::size_t GetCyclesPerFrame() const { return _instructionsPerSecond / timerFrequency; }
+
+			// batched runs stop before executing an instruction at a breakpoint, unless it's the first one
+			void SetBreakpoint(const TwoBytes address, const bool enabled);
+			void ClearBreakpoints();
+			[[nodiscard]] bool HasBreakpoint(const std::size_t address) const
+			{
+				return _breakpoints[address & addressMask];
+			}
+
 			void Rewind();
 			Instruction::Enum GetLastExecutedInstructionCode() const { return _lastExecutedInstructionCode; }
 			TwoBytes GetLastExecutedInstruction() const { return _lastExecutedInstruction; }
@@ -35,6 +84,44 @@ namespace emu
 			const auto& GetCpu() const { return _cpu; }
 			const auto& GetRam() const { return _ram; }
 			auto& GetKeypad() { return _keypad; }
+			auto& GetRng() { return _rng; }
+
+			// cached interpreter: every instruction in [0x200, 0xFFF] is decoded only once, until it's overwritten
+			void SetInstructionCacheEnabled(const bool enabled);
+			[[nodiscard]] bool IsInstructionCacheEnabled() const { return _useInstructionCache; }
+
+			// Annn+Dxyn, Fx07+3xkk+1nnn and 7xkk+3xkk run as a single fused handler, with or without the instruction
+			// cache. Not while tracing, as the instructions in between aren't recorded
+			void SetSuperinstructionsEnabled(const bool enabled);
+			[[nodiscard]] bool AreSuperinstructionsEnabled() const { return _useSuperinstructions; }
+			// reset by LoadRom
+			[[nodiscard]] const auto& GetSuperinstructionStatistics() const { return _superinstructionStatistics; }
+
+			// RunCycles only: hot straight-line blocks are compiled to native code, where supported
+			void SetJitEnabled(const bool enabled);
+			[[nodiscard]] bool IsJitEnabled() const { return _jit && _jit->IsValid(); }
+			[[nodiscard]] const Jit* GetJit() const { return _jit.get(); }
+
+			// binary trace of every instruction executed from now on, see TraceRecorder: batched runs go one
+			// instruction at a time while tracing, as neither jit blocks nor threaded dispatch are traced
+			bool StartTrace(const std::filesystem::path& path,
+							const std::size_t capacity = TraceRecorder::defaultCapacity);
+			void StopTrace() { _traceRecorder.reset(); }
+			[[nodiscard]] bool IsTracing() const { return _traceRecorder != nullptr; }
+
+			// nullptr unless built with CHIP8_PROFILER, reset by LoadRom: batched runs skip jit blocks while profiling
+			[[nodiscard]] const Profile* GetProfile() const { return _profile.get(); }
+			void ResetProfile()
+			{
+				if (_profile)
+					*_profile = Profile {};
+			}
+
+			// batched runs only: the guest call stack is sampled every period instructions, starting afresh every time
+			// it's enabled. nullptr unless enabled
+			void SetSamplingProfilerEnabled(const bool enabled,
+											const std::size_t period = SamplingProfiler::defaultPeriod);
+			[[nodiscard]] const SamplingProfiler* GetSamplingProfiler() const { return _samplingProfiler.get(); }
 
 			[[nodiscard]] bool IsValid() const { return _lastError == Error::None; }
 			[[nodiscard]] auto GetLastError() const { return _lastError; }
@@ -44,11 +131,90 @@ namespace emu
 
 		protected:
 			TwoBytes FetchInstruction();
+			const DecodedInstruction& FetchAndDecodeInstruction();
 			bool ExecuteInstruction(const TwoBytes instruction);
+			bool ExecuteInstruction(const DecodedInstruction& decodedInstruction);
+
+			// Cycle() for an instruction known ahead of time, e.g. by a statically recompiled ROM: no fetch, no dispatch
+			template<Instruction::Enum instructionCode>
+			bool CycleStatic(const Opcode opcode);
+			// as Cycle(), executing at most maxInstructions: returns how many were executed, 0 on errors
+			std::size_t Dispatch(const std::size_t maxInstructions);
 
 		private:
 			void Initialize();
-			void PopulateInstructionSetFunctionPointers();
+
+			// the only place where the timers are decremented
+			void AdvanceClock(const std::size_t nInstructions)
+			{
+				_clockPhase += nInstructions * timerFrequency;
+				while (_clockPhase >= _instructionsPerSecond)
+				{
+					_clockPhase -= _instructionsPerSecond;
+					_cpu.DecrementTimers();
+				}
+			}
+
+			// records the instruction just executed, fetched at programCounter
+			void Trace(const TwoBytes programCounter)
+			{
+				// Fx0A moves pc back onto itself until a key is pressed
+				const auto registerIndex = GetWrittenRegister(_lastExecutedInstructionCode, _lastExecutedInstruction,
+															  _cpu.GetProgramCounter() == programCounter);
+				const auto registerValue =
+					registerIndex == TraceRecord::noRegister ? Byte { 0 } : _cpu.GetRegisters()[registerIndex];
+				_traceRecorder->Record(programCounter, _lastExecutedInstruction, _cpu.GetIndexRegister(), registerIndex,
+									   registerValue);
+			}
+
+			// the engine behind RunCycles: returns how many instructions were executed
+			std::size_t Execute(const std::size_t nCycles);
+			// as Execute, stopping to take a sample every period instructions
+			std::size_t ExecuteSampled(const std::size_t nCycles);
+			void BeginRun(const bool stopOnDisplayChange);
+			RunResult EndRun(const std::size_t cycles) const;
+			[[nodiscard]] bool IsBreakpointHit(const std::size_t cycles) const
+			{
+				return cycles > 0 && HasBreakpoint(_cpu.GetProgramCounter());
+			}
+			void OnDisplayChanged()
+			{
+				_displayChanged = true;
+				if (_stopOnDisplayChange)
+					_stopReason = StopReason::DisplayChanged;
+			}
+			// the only instructions that can stop a batched run (besides errors)
+			static constexpr bool CanStopRun(const Instruction::Enum code)
+			{
+				return code == Instruction::_0x00E0 || code == Instruction::_0xDxyn || code == Instruction::_0xFx0A;
+			}
+
+#ifdef CHIP8_USE_THREADED_DISPATCH
+			// each handler jumps straight to the next one, rather than going back to a single dispatch site
+			std::size_t RunCyclesThreaded(const std::size_t nCycles);
+#endif
+
+			// the instructions a superinstruction is made of, decoded
+			using SuperinstructionOperands = std::array<const DecodedInstruction*, maxSuperinstructionLength>;
+			// returns how many instructions were executed, 0 if there's no superinstruction at pc
+			std::size_t ExecuteSuperinstruction(const std::size_t maxInstructions);
+			// instructions points to the decoded instructions: in the instruction cache, or in operands
+			Superinstruction::Enum FetchSuperinstruction(const DecodedInstruction* const*& instructions,
+														 SuperinstructionOperands& operands);
+			Superinstruction::Enum MatchSuperinstructionAt(const std::size_t address,
+														   SuperinstructionOperands& operands) const;
+			TwoBytes PeekInstruction(const std::size_t address) const;
+
+			void InvalidateInstructionCache(const std::size_t memoryStart, const std::size_t nElements);
+			void ClearInstructionCache();
+
+			// one handler per Instruction::Enum: Instruction::END handles all illegal opcodes
+			template<Instruction::Enum instructionCode>
+			void ExecuteWorker(const Opcode opcode);
+
+			using InstructionHandler = void (Chip8::*)(const Opcode);
+			using InstructionHandlers = std::array<InstructionHandler, nInstructions>;
+			static constexpr InstructionHandlers MakeInstructionHandlers();
 
 		protected:
 			CpuT _cpu {};
@@ -58,22 +224,56 @@ namespace emu
 			KeypadT _keypad {};
 
 		private:
+			// built at compile time and shared by all the instances
+			static const InstructionHandlers _instructionHandlers;
+
+			// one slot per even address in [0x200, 0xFFF], nullptr when it has to be decoded (again)
+			static constexpr std::size_t instructionCacheStart = 0x200;
+			static constexpr std::size_t instructionCacheEnd = 0x1000;
+			static constexpr std::size_t instructionCacheSize = (instructionCacheEnd - instructionCacheStart) / 2;
+			std::array<const DecodedInstruction*, instructionCacheSize> _instructionCache {};
+			bool _useInstructionCache = true;
+
+			// same slots as _instructionCache, Superinstruction::END when there's none: the instructions it's made of are
+			// in _instructionCache, from its own slot on
+			static constexpr Byte unknownSuperinstruction = 0xFF;
+			std::array<Byte, instructionCacheSize> _superinstructionCache {};
+			bool _useSuperinstructions = false;
+			SuperinstructionStatistics _superinstructionStatistics {};
+
+			// nullptr unless enabled
+			std::unique_ptr<Jit> _jit {};
+			// nullptr unless tracing
+			std::unique_ptr<TraceRecorder> _traceRecorder {};
+			// nullptr unless enabled
+			std::unique_ptr<SamplingProfiler> _samplingProfiler {};
+#ifdef CHIP8_PROFILER
+			std::unique_ptr<Profile> _profile { std::make_unique<Profile>() };
+#else
+			std::unique_ptr<Profile> _profile {};
+#endif
+
 			TwoBytes _lastExecutedInstruction = 0x0;
 			Instruction::Enum _lastExecutedInstructionCode = Instruction::END;
-			using InstructionSetWorker = std::function<void(const TwoBytes)>;
-			using InstructionPair = std::pair<Instruction::Enum, InstructionSetWorker>;
 
-			std::array<InstructionPair, detail::_uniquePatternInstructions.size()> _uniquePatternInstructions{};
-			std::array<InstructionPair, detail::_0x80xyInstructions.size()> _0x80xyInstructions{};
-			std::array<InstructionPair, detail::_0x00EkInstructions.size()> _0x00EkInstructions{};
-			std::array<InstructionPair, detail::_0xExyzInstructions.size()> _0xExyzInstructions{};
-			std::array<InstructionPair, detail::_0xFxyzInstructions.size()> _0xFxyzInstructions{};
+			Error::Enum _lastError = Error::None;
 
-			static constexpr size_t functionTableSize = 0x10;
-			std::array<InstructionPair, functionTableSize> _instructionSet{};
+			static constexpr std::size_t defaultInstructionsPerSecond = 600;
+			std::size_t _instructionsPerSecond = defaultInstructionsPerSecond;
+			// instructions executed since the last tick, times timerFrequency
+			std::size_t _clockPhase = 0;
+			// RunFor: instructions due, but not executed yet
+			double _pendingCycles = 0.0;
+			// RunFor doesn't catch up with longer stalls, e.g. a paused or dragged window
+			static constexpr double maxCatchUpSeconds = 0.25;
 
-			Error::Enum _lastError = Error::None;
-			const std::function<void(const TwoBytes)> _invalidInstruction;
+			static constexpr std::size_t addressMask = 0xFFF;
+			std::bitset<addressMask + 1> _breakpoints {};
+
+			// state of the current batched run
+			StopReason::Enum _stopReason = StopReason::None;
+			bool _stopOnDisplayChange = false;
+			bool _displayChanged = false;
 		};
 	}	 // namespace detail
 
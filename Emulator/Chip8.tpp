@@ -1,219 +1,137 @@
 
 #include "Emulator/Logging.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
 namespace emu::detail
 {
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	const typename Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::InstructionHandlers
+		Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::_instructionHandlers =
+			Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::MakeInstructionHandlers();
+
 	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
 	Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::Chip8()
-		: _invalidInstruction(
-			  [this](const TwoBytes instruction)
-			  {
-				  LOG_CRITICAL("this instruction({}) shouldn't be called", instruction);
-				  _lastError = Error::InvalidInstruction;
-			  })
 	{
 		Initialize();
-		PopulateInstructionSetFunctionPointers();
-	}
-
-	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
-	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::PopulateInstructionSetFunctionPointers()
-	{
-		_uniquePatternInstructions[0x0] = { detail::_uniquePatternInstructions[0x0], _invalidInstruction };
-		_uniquePatternInstructions[0x1] = { detail::_uniquePatternInstructions[0x1], [this](const TwoBytes instruction)
-											{ this->_cpu.JumpToAddress(instruction); } };
-		_uniquePatternInstructions[0x2] = { detail::_uniquePatternInstructions[0x2], [this](const TwoBytes instruction)
-											{ this->_cpu.CallSubRoutine(instruction); } };
-		_uniquePatternInstructions[0x3] = { detail::_uniquePatternInstructions[0x3], [this](const TwoBytes instruction)
-											{ this->_cpu.ConditionalSkipIfByteEqual(instruction); } };
-		_uniquePatternInstructions[0x4] = { detail::_uniquePatternInstructions[0x4], [this](const TwoBytes instruction)
-											{ this->_cpu.ConditionalSkipIfByteNotEqual(instruction); } };
-		_uniquePatternInstructions[0x5] = { detail::_uniquePatternInstructions[0x5], [this](const TwoBytes instruction)
-											{ this->_cpu.ConditionalSkipIfRegistersEqual(instruction); } };
-		_uniquePatternInstructions[0x6] = { detail::_uniquePatternInstructions[0x6],
-											[this](const TwoBytes instruction) { this->_cpu.LoadByte(instruction); } };
-		_uniquePatternInstructions[0x7] = { detail::_uniquePatternInstructions[0x7], [this](const TwoBytes instruction)
-											{ this->_cpu.AddEqualByte(instruction); } };
-		_uniquePatternInstructions[0x8] = { detail::_uniquePatternInstructions[0x8], _invalidInstruction };
-		_uniquePatternInstructions[0x9] = { detail::_uniquePatternInstructions[0x9], [this](const TwoBytes instruction)
-											{ this->_cpu.ConditionalSkipIfRegistersNotEqual(instruction); } };
-		_uniquePatternInstructions[0xA] = { detail::_uniquePatternInstructions[0xA], [this](const TwoBytes instruction)
-											{ this->_cpu.SetIndexRegister(instruction); } };
-		_uniquePatternInstructions[0xB] = { detail::_uniquePatternInstructions[0xB], [this](const TwoBytes instruction)
-											{ this->_cpu.JumpToLastTwelveBitsPlusFirstRegister(instruction); } };
-		_uniquePatternInstructions[0xC] = { detail::_uniquePatternInstructions[0xC], [this](const TwoBytes instruction)
-											{ this->_cpu.RandomAndEqualByte(instruction, this->_rng); } };
-		_uniquePatternInstructions[0xD] = { detail::_uniquePatternInstructions[0xD], [this](const TwoBytes instruction)
-											{ this->_cpu.Draw(instruction, this->_display, this->_ram); } };
-
-		_0x80xyInstructions[0x0] = { detail::_0x80xyInstructions[0x0],
-									 [this](const TwoBytes instruction) { this->_cpu.LoadRegister(instruction); } };
-		_0x80xyInstructions[0x1] = { detail::_0x80xyInstructions[0x1],
-									 [this](const TwoBytes instruction) { this->_cpu.OrEqualRegister(instruction); } };
-		_0x80xyInstructions[0x2] = { detail::_0x80xyInstructions[0x2],
-									 [this](const TwoBytes instruction) { this->_cpu.AndEqualRegister(instruction); } };
-		_0x80xyInstructions[0x3] = { detail::_0x80xyInstructions[0x3],
-									 [this](const TwoBytes instruction) { this->_cpu.XorEqualRegister(instruction); } };
-		_0x80xyInstructions[0x4] = { detail::_0x80xyInstructions[0x4], [this](const TwoBytes instruction)
-									 { this->_cpu.AddRegistersAndStoreLastByte(instruction); } };
-		_0x80xyInstructions[0x5] = { detail::_0x80xyInstructions[0x5], [this](const TwoBytes instruction)
-									 { this->_cpu.SubtractEqualRegisters(instruction); } };
-		_0x80xyInstructions[0x6] = { detail::_0x80xyInstructions[0x6], [this](const TwoBytes instruction)
-									 { this->_cpu.ShiftRightAndStoreLastBit(instruction); } };
-		_0x80xyInstructions[0x7] = { detail::_0x80xyInstructions[0x7], [this](const TwoBytes instruction)
-									 { this->_cpu.OppositeSubtractRegisters(instruction); } };
-		for (size_t i = 0x8; i <= 0xD; ++i)
-			_0x80xyInstructions[i] = { detail::_0x80xyInstructions[i], _invalidInstruction };
-		_0x80xyInstructions[0xE] = { detail::_0x80xyInstructions[0xE], [this](const TwoBytes instruction)
-									 { this->_cpu.ShiftLeftAndStoreFirstBit(instruction); } };
-
-		_0x00EkInstructions.fill({ Instruction::END, _invalidInstruction });
-		_0x00EkInstructions[0x0] = { detail::_0x00EkInstructions[0x0],
-									 [this](const TwoBytes) { this->_display.Clear(); } };
-		_0x00EkInstructions[0xE] = { detail::_0x00EkInstructions[0xE],
-									 [this](const TwoBytes) { this->_cpu.ReturnFromSubRoutine(); } };
-
-		_0xExyzInstructions.fill({ Instruction::END, _invalidInstruction });
-		_0xExyzInstructions[0x1] = { detail::_0xExyzInstructions[0x1], [this](const TwoBytes instruction)
-									 { this->_cpu.ConditionalSkipIfKeyNotPressed(instruction, this->_keypad); } };
-		_0xExyzInstructions[0xE] = { detail::_0xExyzInstructions[0xE], [this](const TwoBytes instruction)
-									 { this->_cpu.ConditionalSkipIfKeyPressed(instruction, this->_keypad); } };
-
-		_0xFxyzInstructions.fill({ Instruction::END, _invalidInstruction });
-		_0xFxyzInstructions[0x07] = { detail::_0xFxyzInstructions[0x07],
-									  [this](const TwoBytes instruction) { this->_cpu.LoadDelayTimer(instruction); } };
-		_0xFxyzInstructions[0x0A] = { detail::_0xFxyzInstructions[0x0A], [this](const TwoBytes instruction)
-									  { this->_cpu.WaitUntilKeyIsPressed(instruction, this->_keypad); } };
-		_0xFxyzInstructions[0x15] = { detail::_0xFxyzInstructions[0x15],
-									  [this](const TwoBytes instruction) { this->_cpu.SetDelayTimer(instruction); } };
-		_0xFxyzInstructions[0x18] = { detail::_0xFxyzInstructions[0x18],
-									  [this](const TwoBytes instruction) { this->_cpu.SetSoundTimer(instruction); } };
-		_0xFxyzInstructions[0x1E] = { detail::_0xFxyzInstructions[0x1E], [this](const TwoBytes instruction)
-									  { this->_cpu.IndexRegisterAddEqualRegister(instruction); } };
-		_0xFxyzInstructions[0x29] = { detail::_0xFxyzInstructions[0x29], [this](const TwoBytes instruction)
-									  { this->_cpu.LoadFontIntoIndexRegister(instruction, this->_ram); } };
-		_0xFxyzInstructions[0x33] = { detail::_0xFxyzInstructions[0x33], [this](const TwoBytes instruction)
-									  { this->_cpu.StoreBinaryCodeRepresentation(instruction, this->_ram); } };
-		_0xFxyzInstructions[0x55] = { detail::_0xFxyzInstructions[0x55], [this](const TwoBytes instruction)
-									  { this->_cpu.StoreRegistersInRam(instruction, this->_ram); } };
-		_0xFxyzInstructions[0x65] = { detail::_0xFxyzInstructions[0x65], [this](const TwoBytes instruction)
-									  { this->_cpu.LoadRegistersFromRam(instruction, this->_ram); } };
-
-		utils::ConstexprFor<0, 0x10>(
-			[&](const auto i)
-			{
-				if constexpr (i == 0)
-				{
-					_instructionSet[i] = {
-						Instruction::END,
-						[&](const TwoBytes instruction)
-						{
-							const auto lowestFourBits = utils::LowestFourBits(instruction);
-							if (lowestFourBits >= _0x00EkInstructions.size())
-							{
-								LOG_CRITICAL(
-									"instruction({0:d}|{0:X}) msb({1:d}|{1:X}): 0x00E{1:X} -> illegal instruction",
-									instruction, static_cast<Byte>((instruction & 0xF000ul) >> 12ul));
-								_lastError = Error::InvalidInstruction;
-								return;
-							}
-
-							LOG_INFO("instruction({0:d}|{0:X}) msb({1:d}|{1:X}) lowestFourBits({2:d}|{2:X}) 0x00E{2:X}",
-									 instruction, static_cast<Byte>((instruction & 0xF000ul) >> 12ul), lowestFourBits);
-							_0x00EkInstructions[lowestFourBits].second(instruction);
-							_lastExecutedInstructionCode = _0x00EkInstructions[lowestFourBits].first;
-							_lastExecutedInstruction = instruction;
-						}
-					};
-				}
-				else if constexpr (i == 8)
-				{
-					_instructionSet[i] = {
-						Instruction::END,
-						[&](const TwoBytes instruction)
-						{
-							const auto lastFourBits = utils::LowestFourBits(instruction);
-							if (lastFourBits >= _0x80xyInstructions.size())
-							{
-								LOG_CRITICAL(
-									"instruction({0:d}|{0:X}) msb({1:d}|{1:X}) lastFourBits({1:X}): 0x80{1:X} -> illegal instruction",
-									instruction, static_cast<Byte>((instruction & 0xF000ul) >> 12ul), lastFourBits);
-								_lastError = Error::InvalidInstruction;
-								return;
-							}
-							LOG_INFO("instruction({0:d}|{0:X}) msb({1:d}|{1:X}) last4Bits({2:d}|{2:X}): 0x8xy{2:X}",
-									 instruction, static_cast<Byte>((instruction & 0xF000ul) >> 12ul), lastFourBits);
-							_0x80xyInstructions[lastFourBits].second(instruction);
-							_lastExecutedInstructionCode = _0x80xyInstructions[lastFourBits].first;
-							_lastExecutedInstruction = instruction;
-						}
-					};
-				}
-				else if constexpr (i == 0xE)
-				{
-					_instructionSet[i] = {
-						Instruction::END,
-						[&](const TwoBytes instruction)
-						{
-							const auto lastFourBits = utils::LowestFourBits(instruction);
-							if (lastFourBits >= _0xExyzInstructions.size())
-							{
-								LOG_CRITICAL(
-									"instruction({0:d}|{0:X}) msb({1:d}|{1:X}) lastFourBits({1:X}): 0xExy{1:X} -> illegal instruction",
-									instruction, static_cast<Byte>((instruction & 0xF000ul) >> 12ul), lastFourBits);
-								_lastError = Error::InvalidInstruction;
-								return;
-							}
-							LOG_INFO("instruction({0:d}|{0:X}) msb({1:d}|{1:X}) last4Bits({2:d}|{2:X}): 0xExy{2:X}",
-									 instruction, static_cast<Byte>((instruction & 0xF000ul) >> 12ul), lastFourBits);
-							_0xExyzInstructions[lastFourBits].second(instruction);
-							_lastExecutedInstructionCode = _0xExyzInstructions[lastFourBits].first;
-							_lastExecutedInstruction = instruction;
-						}
-					};
-				}
-				else if constexpr (i == 0xF)
-				{
-					_instructionSet[i] = {
-						Instruction::END,
-						[&](const TwoBytes instruction)
-						{
-							const auto lowestByte = utils::LowestByte(instruction);
-							if (lowestByte >= _0xFxyzInstructions.size())
-							{
-								LOG_CRITICAL(
-									"instruction({0:d}|{0:X}) msb({1:d}|{1:X}) lowestByte(1:X): 0xFx{2:X} -> illegal instruction",
-									instruction, static_cast<Byte>((instruction & 0xF000ul) >> 12ul), lowestByte);
-								_lastError = Error::InvalidInstruction;
-								return;
-							}
-							LOG_INFO("instruction({0:d}|{0:X}) msb({1:d}|{1:X}) last4Bits({2:d}|{2:X}): 0xFx{2:X}",
-									 instruction, static_cast<Byte>((instruction & 0xF000ul) >> 12ul), lowestByte);
-							_0xFxyzInstructions[lowestByte].second(instruction);
-							_lastExecutedInstructionCode = _0xFxyzInstructions[lowestByte].first;
-							_lastExecutedInstruction = instruction;
-						}
-					};
-				}
-				else
-				{
-					_instructionSet[i] = { Instruction::END, [&](const TwoBytes instruction)
-										   {
-											   const auto mostSignificantBit =
-												   static_cast<Byte>((instruction & 0xF000ul) >> 12ul);
-
-											   LOG_INFO("instruction({0:d}|{0:X}) msb({1:d}|{1:X}) 0x{1:X}xyz",
-														instruction, mostSignificantBit);
-											   _uniquePatternInstructions[mostSignificantBit].second(instruction);
-											   _lastExecutedInstructionCode =
-												   _uniquePatternInstructions[mostSignificantBit].first;
-											   _lastExecutedInstruction = instruction;
-										   } };
-				}
-			});
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	constexpr typename Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::InstructionHandlers
+	Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::MakeInstructionHandlers()
+	{
+		InstructionHandlers ret {};
+		utils::ConstexprFor<0, nInstructions>(
+			[&](const auto i) { ret[i] = &Chip8::ExecuteWorker<static_cast<Instruction::Enum>(i.value)>; });
+
+		return ret;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	template<Instruction::Enum instructionCode>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::ExecuteWorker(const Opcode opcode)
+	{
+		if constexpr (instructionCode == Instruction::_0x00E0)
+		{
+			_display.Clear();
+			OnDisplayChanged();
+		}
+		else if constexpr (instructionCode == Instruction::_0x00EE)
+			_cpu.ReturnFromSubRoutine();
+
+		else if constexpr (instructionCode == Instruction::_0x1nnn)
+			_cpu.JumpToAddress(opcode);
+		else if constexpr (instructionCode == Instruction::_0x2nnn)
+			_cpu.CallSubRoutine(opcode);
+		else if constexpr (instructionCode == Instruction::_0x3xkk)
+			_cpu.ConditionalSkipIfByteEqual(opcode);
+		else if constexpr (instructionCode == Instruction::_0x4xkk)
+			_cpu.ConditionalSkipIfByteNotEqual(opcode);
+		else if constexpr (instructionCode == Instruction::_0x5xy0)
+			_cpu.ConditionalSkipIfRegistersEqual(opcode);
+		else if constexpr (instructionCode == Instruction::_0x6xkk)
+			_cpu.LoadByte(opcode);
+		else if constexpr (instructionCode == Instruction::_0x7xkk)
+			_cpu.AddEqualByte(opcode);
+
+		else if constexpr (instructionCode == Instruction::_0x8xy0)
+			_cpu.LoadRegister(opcode);
+		else if constexpr (instructionCode == Instruction::_0x8xy1)
+			_cpu.OrEqualRegister(opcode);
+		else if constexpr (instructionCode == Instruction::_0x8xy2)
+			_cpu.AndEqualRegister(opcode);
+		else if constexpr (instructionCode == Instruction::_0x8xy3)
+			_cpu.XorEqualRegister(opcode);
+		else if constexpr (instructionCode == Instruction::_0x8xy4)
+			_cpu.AddRegistersAndStoreLastByte(opcode);
+		else if constexpr (instructionCode == Instruction::_0x8xy5)
+			_cpu.SubtractEqualRegisters(opcode);
+		else if constexpr (instructionCode == Instruction::_0x8xy6)
+			_cpu.ShiftRightAndStoreLastBit(opcode);
+		else if constexpr (instructionCode == Instruction::_0x8xy7)
+			_cpu.OppositeSubtractRegisters(opcode);
+		else if constexpr (instructionCode == Instruction::_0x8xyE)
+			_cpu.ShiftLeftAndStoreFirstBit(opcode);
+
+		else if constexpr (instructionCode == Instruction::_0x9xy0)
+			_cpu.ConditionalSkipIfRegistersNotEqual(opcode);
+		else if constexpr (instructionCode == Instruction::_0xAnnn)
+			_cpu.SetIndexRegister(opcode);
+		else if constexpr (instructionCode == Instruction::_0xBnnn)
+			_cpu.JumpToLastTwelveBitsPlusFirstRegister(opcode);
+		else if constexpr (instructionCode == Instruction::_0xCxkk)
+			_cpu.RandomAndEqualByte(opcode, _rng);
+		else if constexpr (instructionCode == Instruction::_0xDxyn)
+		{
+			_cpu.Draw(opcode, _display, _ram);
+			OnDisplayChanged();
+		}
+
+		else if constexpr (instructionCode == Instruction::_0xExA1)
+			_cpu.ConditionalSkipIfKeyNotPressed(opcode, _keypad);
+		else if constexpr (instructionCode == Instruction::_0xEx9E)
+			_cpu.ConditionalSkipIfKeyPressed(opcode, _keypad);
+
+		else if constexpr (instructionCode == Instruction::_0xFx07)
+			_cpu.LoadDelayTimer(opcode);
+		else if constexpr (instructionCode == Instruction::_0xFx0A)
+		{
+			// pc is moved back onto this instruction when there's no key pressed
+			const auto programCounter = _cpu.GetProgramCounter();
+			_cpu.WaitUntilKeyIsPressed(opcode, _keypad);
+			if (_cpu.GetProgramCounter() != programCounter)
+				_stopReason = StopReason::WaitingForKey;
+		}
+		else if constexpr (instructionCode == Instruction::_0xFx15)
+			_cpu.SetDelayTimer(opcode);
+		else if constexpr (instructionCode == Instruction::_0xFx18)
+			_cpu.SetSoundTimer(opcode);
+		else if constexpr (instructionCode == Instruction::_0xFx1E)
+			_cpu.IndexRegisterAddEqualRegister(opcode);
+		else if constexpr (instructionCode == Instruction::_0xFx29)
+			_cpu.LoadFontIntoIndexRegister(opcode, _ram);
+		else if constexpr (instructionCode == Instruction::_0xFx33)
+		{
+			_cpu.StoreBinaryCodeRepresentation(opcode, _ram);
+			InvalidateInstructionCache(_cpu.GetIndexRegister(), 3);
+		}
+		else if constexpr (instructionCode == Instruction::_0xFx55)
+		{
+			_cpu.StoreRegistersInRam(opcode, _ram);
+			InvalidateInstructionCache(_cpu.GetIndexRegister(), opcode.x + 1u);
+		}
+		else if constexpr (instructionCode == Instruction::_0xFx65)
+			_cpu.LoadRegistersFromRam(opcode, _ram);
+
+		else
+		{
+			static_assert(instructionCode == Instruction::END);
+			LOG_CRITICAL("instruction({0:d}|{0:X}) msb({1:d}|{1:X}) -> illegal instruction", opcode.instruction,
+						 static_cast<Byte>((opcode.instruction & 0xF000ul) >> 12ul));
+			_lastError = Error::InvalidInstruction;
+		}
 	}
 
 	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
@@ -222,6 +140,11 @@ namespace emu::detail
 		_cpu = CpuT {};
 		_display = DisplayT {};
 		_keypad = KeypadT {};
+		ClearInstructionCache();
+		_superinstructionStatistics = SuperinstructionStatistics {};
+		ResetProfile();
+		_clockPhase = 0;
+		_pendingCycles = 0.0;
 
 		_cpu.SetProgramCounter(static_cast<TwoBytes>(_ram.GetInstructionStartAddress()));
 		LOG_TRACE("Chip8 created and pc={}", _cpu.GetProgramCounter());
@@ -262,31 +185,427 @@ namespace emu::detail
 
 	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
 	bool Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::Cycle()
+	{
+#ifdef CHIP8_USE_THREADED_DISPATCH
+		if (!_useSuperinstructions)
+		{
+			const auto programCounter = _cpu.GetProgramCounter();
+			if (RunCyclesThreaded(1) != 1)
+				return false;
+
+			if (_traceRecorder)
+				Trace(programCounter);
+			return true;
+		}
+#endif
+
+		return Dispatch(maxSuperinstructionLength) > 0;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	std::size_t Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::Dispatch(const std::size_t maxInstructions)
 	{
 		if (!IsValid())
-			return false;
+			return 0;
 
-		const auto instruction = FetchInstruction();
-		LOG_TRACE("fetched instruction({0:d}|{0:X})", instruction);
+		const auto programCounter = _cpu.GetProgramCounter();
+		const auto& decodedInstruction = FetchAndDecodeInstruction();
+		LOG_TRACE("fetched instruction({0:d}|{0:X})", decodedInstruction.opcode.instruction);
 
-		if (_cpu.GetProgramCounter() < _ram.GetInstructionStartAddress())
+		if (programCounter < _ram.GetInstructionStartAddress())
 		{
 			_lastError = Error::InvalidProgramCounter;
-			return false;
+			return 0;
+		}
+
+		// any other instruction is dispatched on its own, without looking any further
+		if (_useSuperinstructions && StartsSuperinstruction(decodedInstruction.code) && maxInstructions > 1 &&
+			!_traceRecorder)
+		{
+			const auto nExecuted = ExecuteSuperinstruction(maxInstructions);
+			if (nExecuted > 0)
+				return nExecuted;
 		}
 
 		// pc += 2
 		_cpu.AdvanceProgramCounter();
 
 		// now execute the instruction
-		if (!ExecuteInstruction(instruction))
+		if (!ExecuteInstruction(decodedInstruction))
+			return 0;
+
+		AdvanceClock(1);
+
+		if (_traceRecorder)
+			Trace(programCounter);
+		return 1;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	template<Instruction::Enum instructionCode>
+	bool Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::CycleStatic(const Opcode opcode)
+	{
+		if (!IsValid())
+			return false;
+
+		const auto programCounter = _cpu.GetProgramCounter();
+		_cpu.AdvanceProgramCounter();
+
+		_lastExecutedInstructionCode = Instruction::END;
+		_lastExecutedInstruction = 0x0;
+#ifdef CHIP8_PROFILER
+		const auto start = utils::ReadTimeStampCounter();
+		ExecuteWorker<instructionCode>(opcode);
+		_profile->Add(instructionCode, programCounter, utils::ReadTimeStampCounter() - start);
+#else
+		ExecuteWorker<instructionCode>(opcode);
+#endif
+		if constexpr (instructionCode == Instruction::END)
 			return false;
 
-		_cpu.DecrementTimers();
+		_lastExecutedInstructionCode = instructionCode;
+		_lastExecutedInstruction = opcode.instruction;
+		AdvanceClock(1);
 
+		if (_traceRecorder)
+			Trace(programCounter);
 		return true;
 	}
 
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	RunResult Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::RunCycles(const std::size_t nCycles,
+																	const bool stopOnDisplayChange)
+	{
+		BeginRun(stopOnDisplayChange);
+		return EndRun(_samplingProfiler ? ExecuteSampled(nCycles) : Execute(nCycles));
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	RunResult Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::RunCyclesThroughKeyWaits(const std::size_t nCycles,
+																				   const bool stopOnDisplayChange)
+	{
+		RunResult result;
+		while (result.cycles < nCycles)
+		{
+			const auto partial = RunCycles(nCycles - result.cycles, stopOnDisplayChange);
+			result.cycles += partial.cycles;
+			result.stopReason = partial.stopReason;
+			result.displayChanged |= partial.displayChanged;
+
+			// Fx0A counts as an instruction each time it's replayed, the others are up to the caller
+			if (partial.stopReason != StopReason::WaitingForKey || partial.cycles == 0)
+				break;
+		}
+
+		return result;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	RunResult Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::RunFrame(const bool stopOnDisplayChange)
+	{
+		return RunCycles(GetCyclesPerFrame(), stopOnDisplayChange);
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	RunResult Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::RunFor(const std::chrono::duration<double> elapsed,
+																  const bool stopOnDisplayChange)
+	{
+		const auto instructionsPerSecond = static_cast<double>(_instructionsPerSecond);
+		_pendingCycles = std::min(_pendingCycles + std::max(elapsed.count(), 0.0) * instructionsPerSecond,
+								  maxCatchUpSeconds * instructionsPerSecond);
+		const auto nCycles = static_cast<std::size_t>(_pendingCycles);
+
+		const auto result = RunCyclesThroughKeyWaits(nCycles, stopOnDisplayChange);
+		_pendingCycles -= static_cast<double>(result.cycles);
+
+		return result;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::SetInstructionsPerSecond(const std::size_t instructionsPerSecond)
+	{
+		// at most one tick per instruction
+		_instructionsPerSecond = std::max(instructionsPerSecond, timerFrequency);
+		_clockPhase = std::min(_clockPhase, _instructionsPerSecond - 1);
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	template<typename Predicate>
+	RunResult Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::RunUntil(Predicate&& predicate, const std::size_t maxCycles,
+																   const bool stopOnDisplayChange)
+	{
+		BeginRun(stopOnDisplayChange);
+
+		std::size_t cycles = 0;
+		while (cycles < maxCycles && _stopReason == StopReason::None)
+		{
+			if (IsBreakpointHit(cycles))
+			{
+				_stopReason = StopReason::Breakpoint;
+				break;
+			}
+			// one instruction at a time, fused or not: the predicate and the breakpoints are checked after each
+			const auto nExecuted = Dispatch(1);
+			if (nExecuted == 0)
+				break;
+			cycles += nExecuted;
+
+			if (_stopReason == StopReason::None && predicate(std::as_const(*this)))
+				_stopReason = StopReason::Predicate;
+		}
+
+		return EndRun(cycles);
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::BeginRun(const bool stopOnDisplayChange)
+	{
+		_stopReason = StopReason::None;
+		_stopOnDisplayChange = stopOnDisplayChange;
+		_displayChanged = false;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	RunResult Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::EndRun(const std::size_t cycles) const
+	{
+		return { cycles, IsValid() ? _stopReason : StopReason::Error, _displayChanged };
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::SetBreakpoint(const TwoBytes address, const bool enabled)
+	{
+		_breakpoints[address & addressMask] = enabled;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::ClearBreakpoints()
+	{
+		_breakpoints.reset();
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	std::size_t Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::Execute(const std::size_t nCycles)
+	{
+		if (_breakpoints.any() || _traceRecorder)
+		{
+			// one instruction at a time: neither jit blocks nor superinstructions can stop in the middle, and jit
+			// blocks aren't traced
+			std::size_t cycles = 0;
+			for (; cycles < nCycles && _stopReason == StopReason::None; ++cycles)
+			{
+				if (IsBreakpointHit(cycles))
+				{
+					_stopReason = StopReason::Breakpoint;
+					break;
+				}
+				if (Dispatch(1) == 0)
+					break;
+			}
+
+			return cycles;
+		}
+
+		// not while profiling, as jit blocks can't be profiled
+		if (IsJitEnabled() && !_profile)
+		{
+			auto& jit = *_jit;
+			std::size_t cycles = 0;
+			while (cycles < nCycles && IsValid() && _stopReason == StopReason::None)
+			{
+				// at a block leader: where the run starts, or right after a block or an instruction that ends one
+				// (jumps, calls, skips, ...). Anywhere else, the block would've started earlier
+				const auto* block = jit.GetBlock(_ram, _cpu.GetProgramCounter());
+				// a block must fit in what's left, so that RunCycles stops exactly at nCycles
+				if (block && block->nInstructions <= nCycles - cycles)
+				{
+					_cpu.ExecuteNativeBlock(*block);
+					AdvanceClock(block->nInstructions);
+					_lastExecutedInstructionCode = block->lastInstructionCode;
+					_lastExecutedInstruction = block->lastInstruction;
+					cycles += block->nInstructions;
+					// otherwise it ended right before an instruction that can't be compiled
+					if (block->nInstructions == Jit::maxBlockInstructions)
+						continue;
+				}
+
+				// interpreted up to the next block leader
+				while (cycles < nCycles)
+				{
+					if (Dispatch(1) == 0)
+						return cycles;
+					++cycles;
+					if (_stopReason != StopReason::None || !Jit::IsCompilable(_lastExecutedInstructionCode))
+						break;
+				}
+			}
+
+			return cycles;
+		}
+
+#ifdef CHIP8_USE_THREADED_DISPATCH
+		// superinstructions go through Dispatch
+		if (!_useSuperinstructions)
+			return RunCyclesThreaded(nCycles);
+#endif
+
+		std::size_t cycles = 0;
+		while (cycles < nCycles)
+		{
+			const auto nExecuted = Dispatch(nCycles - cycles);
+			if (nExecuted == 0)
+				break;
+
+			cycles += nExecuted;
+			if (_stopReason != StopReason::None)
+				break;
+		}
+
+		return cycles;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	std::size_t Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::ExecuteSampled(const std::size_t nCycles)
+	{
+		std::size_t cycles = 0;
+		while (cycles < nCycles)
+		{
+			// Execute only skips breakpoints at its first instruction
+			if (IsBreakpointHit(cycles))
+			{
+				_stopReason = StopReason::Breakpoint;
+				break;
+			}
+
+			const auto chunk = std::min(nCycles - cycles, _samplingProfiler->GetCyclesToNextSample());
+			const auto executed = Execute(chunk);
+			cycles += executed;
+			if (_samplingProfiler->Advance(executed))
+				_samplingProfiler->Sample(_cpu.GetStack().data(), _cpu.GetStackPointer(), _cpu.GetProgramCounter(),
+										  _ram);
+
+			if (executed < chunk || _stopReason != StopReason::None)
+				break;
+		}
+
+		return cycles;
+	}
+
+#ifdef CHIP8_USE_THREADED_DISPATCH
+	__START_IGNORING_WARNINGS__
+	#ifdef __clang__
+	__IGNORE_WARNING__("-Wgnu-label-as-value")
+	#else
+	__IGNORE_WARNING__("-Wpedantic")
+	#endif
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	std::size_t Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::RunCyclesThreaded(const std::size_t nCycles)
+	{
+		// same order as Instruction::Enum
+		static void* const labels[] = {
+			&&execute_0x00E0, &&execute_0x00EE,
+
+			&&execute_0x1nnn, &&execute_0x2nnn, &&execute_0x3xkk, &&execute_0x4xkk,
+			&&execute_0x5xy0, &&execute_0x6xkk, &&execute_0x7xkk,
+
+			&&execute_0x8xy0, &&execute_0x8xy1, &&execute_0x8xy2, &&execute_0x8xy3, &&execute_0x8xy4,
+			&&execute_0x8xy5, &&execute_0x8xy6, &&execute_0x8xy7, &&execute_0x8xyE,
+
+			&&execute_0x9xy0, &&execute_0xAnnn, &&execute_0xBnnn, &&execute_0xCxkk, &&execute_0xDxyn,
+
+			&&execute_0xExA1, &&execute_0xEx9E,
+
+			&&execute_0xFx07, &&execute_0xFx0A, &&execute_0xFx15, &&execute_0xFx18, &&execute_0xFx1E,
+			&&execute_0xFx29, &&execute_0xFx33, &&execute_0xFx55, &&execute_0xFx65,
+
+			&&executeInvalidInstruction,
+		};
+		static_assert(sizeof(labels) / sizeof(labels[0]) == nInstructions);
+
+		if (!IsValid() || nCycles == 0)
+			return 0;
+
+		std::size_t cycles = 0;
+		const DecodedInstruction* decodedInstruction = nullptr;
+
+		// same steps as Cycle(): fetch, check pc, pc += 2, execute, advance the clock
+	#define CHIP8_DISPATCH_NEXT_INSTRUCTION()                                                                          \
+		decodedInstruction = &FetchAndDecodeInstruction();                                                             \
+		LOG_TRACE("fetched instruction({0:d}|{0:X})", decodedInstruction->opcode.instruction);                         \
+		if (_cpu.GetProgramCounter() < _ram.GetInstructionStartAddress())                                              \
+		{                                                                                                              \
+			_lastError = Error::InvalidProgramCounter;                                                                 \
+			return cycles;                                                                                             \
+		}                                                                                                              \
+		_cpu.AdvanceProgramCounter();                                                                                  \
+		LOG_INFO("instruction({0:d}|{0:X}) -> {1}", decodedInstruction->opcode.instruction,                            \
+				 ToString(decodedInstruction->code));                                                                  \
+		goto* labels[decodedInstruction->code]
+
+	#define CHIP8_THREADED_HANDLER(INSTRUCTION_CODE)                                                                   \
+		execute##INSTRUCTION_CODE : ExecuteWorker<Instruction::INSTRUCTION_CODE>(decodedInstruction->opcode);          \
+		_lastExecutedInstructionCode = Instruction::INSTRUCTION_CODE;                                                  \
+		_lastExecutedInstruction = decodedInstruction->opcode.instruction;                                             \
+		AdvanceClock(1);                                                                                               \
+		if (++cycles == nCycles)                                                                                       \
+			return cycles;                                                                                             \
+		if (CanStopRun(Instruction::INSTRUCTION_CODE) && _stopReason != StopReason::None)                              \
+			return cycles;                                                                                             \
+		CHIP8_DISPATCH_NEXT_INSTRUCTION()
+
+		CHIP8_DISPATCH_NEXT_INSTRUCTION();
+
+		CHIP8_THREADED_HANDLER(_0x00E0);
+		CHIP8_THREADED_HANDLER(_0x00EE);
+
+		CHIP8_THREADED_HANDLER(_0x1nnn);
+		CHIP8_THREADED_HANDLER(_0x2nnn);
+		CHIP8_THREADED_HANDLER(_0x3xkk);
+		CHIP8_THREADED_HANDLER(_0x4xkk);
+		CHIP8_THREADED_HANDLER(_0x5xy0);
+		CHIP8_THREADED_HANDLER(_0x6xkk);
+		CHIP8_THREADED_HANDLER(_0x7xkk);
+
+		CHIP8_THREADED_HANDLER(_0x8xy0);
+		CHIP8_THREADED_HANDLER(_0x8xy1);
+		CHIP8_THREADED_HANDLER(_0x8xy2);
+		CHIP8_THREADED_HANDLER(_0x8xy3);
+		CHIP8_THREADED_HANDLER(_0x8xy4);
+		CHIP8_THREADED_HANDLER(_0x8xy5);
+		CHIP8_THREADED_HANDLER(_0x8xy6);
+		CHIP8_THREADED_HANDLER(_0x8xy7);
+		CHIP8_THREADED_HANDLER(_0x8xyE);
+
+		CHIP8_THREADED_HANDLER(_0x9xy0);
+		CHIP8_THREADED_HANDLER(_0xAnnn);
+		CHIP8_THREADED_HANDLER(_0xBnnn);
+		CHIP8_THREADED_HANDLER(_0xCxkk);
+		CHIP8_THREADED_HANDLER(_0xDxyn);
+
+		CHIP8_THREADED_HANDLER(_0xExA1);
+		CHIP8_THREADED_HANDLER(_0xEx9E);
+
+		CHIP8_THREADED_HANDLER(_0xFx07);
+		CHIP8_THREADED_HANDLER(_0xFx0A);
+		CHIP8_THREADED_HANDLER(_0xFx15);
+		CHIP8_THREADED_HANDLER(_0xFx18);
+		CHIP8_THREADED_HANDLER(_0xFx1E);
+		CHIP8_THREADED_HANDLER(_0xFx29);
+		CHIP8_THREADED_HANDLER(_0xFx33);
+		CHIP8_THREADED_HANDLER(_0xFx55);
+		CHIP8_THREADED_HANDLER(_0xFx65);
+
+	executeInvalidInstruction:
+		_lastExecutedInstructionCode = Instruction::END;
+		_lastExecutedInstruction = 0x0;
+		ExecuteWorker<Instruction::END>(decodedInstruction->opcode);
+		return cycles;
+
+	#undef CHIP8_THREADED_HANDLER
+	#undef CHIP8_DISPATCH_NEXT_INSTRUCTION
+	}
+	__STOP_IGNORING_WARNINGS__
+#endif
+
 	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
 	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::Rewind()
 	{
@@ -310,8 +629,231 @@ namespace emu::detail
 		return static_cast<TwoBytes>(topPart | nextMemByte);
 	}
 
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	const DecodedInstruction& Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::FetchAndDecodeInstruction()
+	{
+		const auto pc = _cpu.GetProgramCounter();
+
+		// odd addresses are legal, but rare enough that it's not worth caching them
+		if (!_useInstructionCache || pc < instructionCacheStart || pc >= instructionCacheEnd || (pc & 1u) != 0)
+			return decodeTable[FetchInstruction()];
+
+		auto& cachedInstruction = _instructionCache[(pc - instructionCacheStart) >> 1u];
+		if (cachedInstruction == nullptr)
+			cachedInstruction = &decodeTable[FetchInstruction()];
+		else
+			LOG_DEBUG("pc({0}) cached instruction({1:d}|{1:X})", pc, cachedInstruction->opcode.instruction);
+
+		return *cachedInstruction;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::SetInstructionCacheEnabled(const bool enabled)
+	{
+		_useInstructionCache = enabled;
+		ClearInstructionCache();
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::SetSuperinstructionsEnabled(const bool enabled)
+	{
+		_useSuperinstructions = enabled;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	std::size_t Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::ExecuteSuperinstruction(const std::size_t maxInstructions)
+	{
+		const auto programCounter = _cpu.GetProgramCounter();
+		const DecodedInstruction* const* instructions = nullptr;
+		SuperinstructionOperands operands {};
+		const auto superinstruction = FetchSuperinstruction(instructions, operands);
+		// the longest outcome has to fit, so that a batched run stops exactly at nCycles
+		if (superinstruction == Superinstruction::END || superinstructionLengths[superinstruction] > maxInstructions)
+			return 0;
+
+#ifdef CHIP8_PROFILER
+		const auto start = utils::ReadTimeStampCounter();
+#endif
+		// a single pc update and clock advance for the whole sequence: only its first instruction reads the timers
+		auto nextProgramCounter = static_cast<TwoBytes>(programCounter + 4);
+		std::size_t nExecuted = 2;
+		switch (superinstruction)
+		{
+			case Superinstruction::SetIndexAndDraw:
+				_cpu.SetIndexRegister(instructions[0]->opcode);
+				_cpu.Draw(instructions[1]->opcode, _display, _ram);
+				OnDisplayChanged();
+				break;
+			case Superinstruction::PollDelayTimer:
+			{
+				_cpu.LoadDelayTimer(instructions[0]->opcode);
+
+				// the jump back is skipped once the timer reaches kk
+				const auto& skip = instructions[1]->opcode;
+				if (_cpu.GetRegisters()[skip.x] == skip.kk)
+					nextProgramCounter = static_cast<TwoBytes>(programCounter + 6);
+				else
+				{
+					nextProgramCounter = instructions[2]->opcode.nnn;
+					nExecuted = 3;
+				}
+				break;
+			}
+			case Superinstruction::AddAndSkipIfEqual:
+			{
+				_cpu.AddEqualByte(instructions[0]->opcode);
+
+				const auto& skip = instructions[1]->opcode;
+				if (_cpu.GetRegisters()[skip.x] == skip.kk)
+					nextProgramCounter = static_cast<TwoBytes>(programCounter + 6);
+				break;
+			}
+			default:
+				return 0;
+		}
+		_cpu.SetProgramCounter(nextProgramCounter);
+
+		const auto& lastInstruction = *instructions[nExecuted - 1];
+		_lastExecutedInstructionCode = lastInstruction.code;
+		_lastExecutedInstruction = lastInstruction.opcode.instruction;
+		AdvanceClock(nExecuted);
+
+#ifdef CHIP8_PROFILER
+		// the cost of the whole sequence, split evenly
+		const auto hostCycles = (utils::ReadTimeStampCounter() - start) / nExecuted;
+		for (std::size_t i = 0; i < nExecuted; ++i)
+			_profile->Add(instructions[i]->code, programCounter + 2 * i, hostCycles);
+#endif
+
+		LOG_DEBUG("superinstruction({}) -> {} instructions", ToString(superinstruction), nExecuted);
+		++_superinstructionStatistics.fired[superinstruction];
+		_superinstructionStatistics.dispatchesSaved += nExecuted - 1;
+		return nExecuted;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	Superinstruction::Enum Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::FetchSuperinstruction(
+		const DecodedInstruction* const*& instructions, SuperinstructionOperands& operands)
+	{
+		const auto pc = _cpu.GetProgramCounter();
+		if (!_useInstructionCache || pc < instructionCacheStart || pc >= instructionCacheEnd || (pc & 1u) != 0)
+		{
+			instructions = operands.data();
+			return MatchSuperinstructionAt(pc, operands);
+		}
+
+		const auto slot = (pc - instructionCacheStart) >> 1u;
+		auto& cachedSuperinstruction = _superinstructionCache[slot];
+		if (cachedSuperinstruction == unknownSuperinstruction)
+		{
+			const auto superinstruction = MatchSuperinstructionAt(pc, operands);
+			// decoded once: from then on, the instructions are read from the instruction cache. A write to any of them
+			// invalidates the superinstruction too
+			if (superinstruction != Superinstruction::END)
+				std::copy_n(operands.begin(), superinstructionLengths[superinstruction],
+							_instructionCache.begin() + static_cast<std::ptrdiff_t>(slot));
+			cachedSuperinstruction = static_cast<Byte>(superinstruction);
+		}
+
+		instructions = _instructionCache.data() + slot;
+		return static_cast<Superinstruction::Enum>(cachedSuperinstruction);
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	Superinstruction::Enum
+	Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::MatchSuperinstructionAt(const std::size_t address,
+																		SuperinstructionOperands& operands) const
+	{
+		if (address + 2 * maxSuperinstructionLength > _ram.GetSize())
+			return Superinstruction::END;
+
+		operands[0] = &decodeTable[PeekInstruction(address)];
+		if (!StartsSuperinstruction(operands[0]->code))
+			return Superinstruction::END;
+
+		operands[1] = &decodeTable[PeekInstruction(address + 2)];
+		operands[2] = &decodeTable[PeekInstruction(address + 4)];
+		return MatchSuperinstruction(operands[0]->code, operands[1]->code, operands[2]->code);
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	TwoBytes Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::PeekInstruction(const std::size_t address) const
+	{
+		return static_cast<TwoBytes>((_ram.GetAt(address) << 8u) | _ram.GetAt(address + 1));
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::SetJitEnabled(const bool enabled)
+	{
+		if (!enabled)
+		{
+			_jit.reset();
+			return;
+		}
+
+		if (!Jit::IsSupported())
+			LOG_WARN("jit not supported on this platform: falling back to the interpreter");
+		if (!_jit)
+			_jit = std::make_unique<Jit>();
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::SetSamplingProfilerEnabled(const bool enabled,
+																				 const std::size_t period)
+	{
+		_samplingProfiler = enabled ? std::make_unique<SamplingProfiler>(period) : nullptr;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	bool Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::StartTrace(const std::filesystem::path& path,
+																 const std::size_t capacity)
+	{
+		auto traceRecorder = std::make_unique<TraceRecorder>();
+		if (!traceRecorder->Open(path, capacity))
+			return false;
+
+		_traceRecorder = std::move(traceRecorder);
+		return true;
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::ClearInstructionCache()
+	{
+		_instructionCache.fill(nullptr);
+		_superinstructionCache.fill(unknownSuperinstruction);
+		if (_jit)
+			_jit->Clear();
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	void Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::InvalidateInstructionCache(const std::size_t memoryStart,
+																			   const std::size_t nElements)
+	{
+		// a byte at an odd address is the second half of the instruction starting just before it
+		const auto begin = std::max(memoryStart & ~std::size_t { 1 }, instructionCacheStart);
+		const auto end = std::min(memoryStart + nElements, instructionCacheEnd);
+		LOG_DEBUG("invalidating instruction cache in [{}, {})", begin, end);
+
+		for (auto address = begin; address < end; address += 2)
+			_instructionCache[(address - instructionCacheStart) >> 1u] = nullptr;
+
+		// a superinstruction spans up to the two instructions after its own slot
+		for (auto address = std::max(begin, instructionCacheStart + 4) - 4; address < end; address += 2)
+			_superinstructionCache[(address - instructionCacheStart) >> 1u] = unknownSuperinstruction;
+
+		// self-modifying code: compiled blocks overlapping the write are dropped as well
+		if (_jit)
+			_jit->Invalidate(memoryStart, nElements);
+	}
+
 	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
 	bool Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::ExecuteInstruction(const TwoBytes instruction)
+	{
+		return ExecuteInstruction(decodeTable[instruction]);
+	}
+
+	template<typename CpuT, typename RngT, typename RamT, typename DisplayT, typename KeypadT>
+	bool Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>::ExecuteInstruction(const DecodedInstruction& decodedInstruction)
 	{
 		/*
 		 * If you look at the list of opcodes, you’ll notice that there are four types:
@@ -358,10 +900,24 @@ namespace emu::detail
 		_lastExecutedInstructionCode = Instruction::END;
 		_lastExecutedInstruction = 0x0;
 
-		// zero out the first 3 nibbles and shift it down by 12 bits
-		const auto mostSignificantBit = static_cast<Byte>((instruction & 0xF000ul) >> 12ul);
-		LOG_TRACE("instruction({0:d}|{0:X}): msb({1:d}|{1:X})", instruction, mostSignificantBit);
-		_instructionSet[mostSignificantBit].second(instruction);
+		// no decoding at run time: a single lookup gives both the handler and its operands
+		const auto instruction = decodedInstruction.opcode.instruction;
+		LOG_INFO("instruction({0:d}|{0:X}) -> {1}", instruction, ToString(decodedInstruction.code));
+
+#ifdef CHIP8_PROFILER
+		// pc has already been moved past it
+		const auto programCounter = _cpu.GetProgramCounter() - 2u;
+		const auto start = utils::ReadTimeStampCounter();
+		(this->*_instructionHandlers[decodedInstruction.code])(decodedInstruction.opcode);
+		_profile->Add(decodedInstruction.code, programCounter, utils::ReadTimeStampCounter() - start);
+#else
+		(this->*_instructionHandlers[decodedInstruction.code])(decodedInstruction.opcode);
+#endif
+		if (decodedInstruction.code != Instruction::END)
+		{
+			_lastExecutedInstructionCode = decodedInstruction.code;
+			_lastExecutedInstruction = instruction;
+		}
 
 		return IsValid();
 	}
@@ -383,6 +939,7 @@ namespace emu::detail
 		localByteArray = _ram.Deserialize(localByteArray);
 		localByteArray = _display.Deserialize(localByteArray);
 		localByteArray = _keypad.Deserialize(localByteArray);
+		ClearInstructionCache();
 
 		return localByteArray;
 	}
@@ -1,17 +1,20 @@
 
 #pragma once
 
+#include "Opcode.h"
 #include "Utilities.h"
 #include "ISerializable.h"
 #include <array>
 
 namespace emu
 {
-	class IRng;
-	class IDisplay;
-	class IRam;
-	class IKeypad;
+	struct NativeBlock;
 
+	/*
+	 * The ram/display/keypad/rng components are template parameters of the methods using them: with the concrete
+	 * (final) types, as in emu::Chip8, their calls are resolved statically and can be inlined.
+	 * Passing the I* interfaces (e.g. test doubles) still works, with virtual calls.
+	 * */
 	class Cpu: public ISerializable
 	{
 		static constexpr std::size_t stackSize = 16;
@@ -33,53 +36,65 @@ namespace emu
 		void RetreatProgramCounter();
 
 		void ReturnFromSubRoutine();
-		void JumpToAddress(const TwoBytes instruction);
-		void CallSubRoutine(const TwoBytes instruction);
+		void JumpToAddress(const Opcode opcode);
+		void CallSubRoutine(const Opcode opcode);
 
-		void ConditionalSkipIfByteEqual(const TwoBytes instruction);
-		void ConditionalSkipIfByteNotEqual(const TwoBytes instruction);
-		void ConditionalSkipIfRegistersEqual(const TwoBytes instruction);
-		void ConditionalSkipIfRegistersNotEqual(const TwoBytes instruction);
-		void ConditionalSkipIfKeyPressed(const TwoBytes instruction, const IKeypad& keypad);
-		void ConditionalSkipIfKeyNotPressed(const TwoBytes instruction, const IKeypad& keypad);
+		void ConditionalSkipIfByteEqual(const Opcode opcode);
+		void ConditionalSkipIfByteNotEqual(const Opcode opcode);
+		void ConditionalSkipIfRegistersEqual(const Opcode opcode);
+		void ConditionalSkipIfRegistersNotEqual(const Opcode opcode);
+		template<typename KeypadT>
+		void ConditionalSkipIfKeyPressed(const Opcode opcode, const KeypadT& keypad);
+		template<typename KeypadT>
+		void ConditionalSkipIfKeyNotPressed(const Opcode opcode, const KeypadT& keypad);
 
-		void LoadByte(const TwoBytes instruction);
-		void LoadRegister(const TwoBytes instruction);
-		void LoadDelayTimer(const TwoBytes instruction);
-		void LoadFontIntoIndexRegister(const TwoBytes instruction, const IRam& ram);
-		void LoadRegistersFromRam(const TwoBytes instruction, IRam& ram);
+		void LoadByte(const Opcode opcode);
+		void LoadRegister(const Opcode opcode);
+		void LoadDelayTimer(const Opcode opcode);
+		template<typename RamT>
+		void LoadFontIntoIndexRegister(const Opcode opcode, const RamT& ram);
+		template<typename RamT>
+		void LoadRegistersFromRam(const Opcode opcode, RamT& ram);
 
-		void SetDelayTimer(const TwoBytes instruction);
-		void SetSoundTimer(const TwoBytes instruction);
+		void SetDelayTimer(const Opcode opcode);
+		void SetSoundTimer(const Opcode opcode);
 
-		void StoreBinaryCodeRepresentation(const TwoBytes instruction, IRam& ram);
-		void StoreRegistersInRam(const TwoBytes instruction, IRam& ram);
+		template<typename RamT>
+		void StoreBinaryCodeRepresentation(const Opcode opcode, RamT& ram);
+		template<typename RamT>
+		void StoreRegistersInRam(const Opcode opcode, RamT& ram);
 
-		void AddEqualByte(const TwoBytes instruction);
-		void IndexRegisterAddEqualRegister(const TwoBytes instruction);
+		void AddEqualByte(const Opcode opcode);
+		void IndexRegisterAddEqualRegister(const Opcode opcode);
 
-		void OrEqualRegister(const TwoBytes instruction);
-		void AndEqualRegister(const TwoBytes instruction);
-		void XorEqualRegister(const TwoBytes instruction);
+		void OrEqualRegister(const Opcode opcode);
+		void AndEqualRegister(const Opcode opcode);
+		void XorEqualRegister(const Opcode opcode);
 
-		void AddRegistersAndStoreLastByte(const TwoBytes instruction);
-		void SubtractEqualRegisters(const TwoBytes instruction);
-		void OppositeSubtractRegisters(const TwoBytes instruction);
+		void AddRegistersAndStoreLastByte(const Opcode opcode);
+		void SubtractEqualRegisters(const Opcode opcode);
+		void OppositeSubtractRegisters(const Opcode opcode);
 
-		void ShiftRightAndStoreLastBit(const TwoBytes instruction);
-		void ShiftLeftAndStoreFirstBit(const TwoBytes instruction);
+		void ShiftRightAndStoreLastBit(const Opcode opcode);
+		void ShiftLeftAndStoreFirstBit(const Opcode opcode);
 
-		void SetIndexRegister(const TwoBytes instruction);
-		void JumpToLastTwelveBitsPlusFirstRegister(const TwoBytes instruction);
+		void SetIndexRegister(const Opcode opcode);
+		void JumpToLastTwelveBitsPlusFirstRegister(const Opcode opcode);
 
-		void RandomAndEqualByte(const TwoBytes instruction, IRng& rng);
+		template<typename RngT>
+		void RandomAndEqualByte(const Opcode opcode, RngT& rng);
 
-		void Draw(const TwoBytes instruction, IDisplay& display, const IRam& ram);
+		template<typename DisplayT, typename RamT>
+		void Draw(const Opcode opcode, DisplayT& display, const RamT& ram);
 
-		void WaitUntilKeyIsPressed(const TwoBytes instruction, const IKeypad& keypad);
+		template<typename KeypadT>
+		void WaitUntilKeyIsPressed(const Opcode opcode, const KeypadT& keypad);
 
 		void DecrementTimers();
 
+		// runs a jit-compiled block, and then catches up with pc as if each instruction was interpreted (not the timers)
+		void ExecuteNativeBlock(const NativeBlock& block);
+
 		auto GetIndexRegister() const { return _indexRegister; }
 		auto GetStackPointer() const { return _stackPointer; }
 		const auto& GetStack() const { return _stack; }
@@ -107,3 +122,5 @@ namespace emu
 		Byte _soundTimer = 0;
 	};
 }	 // namespace emu
+
+#include "Cpu.tpp"
@@ -0,0 +1,223 @@
+
+#include "Interfaces/IKeypad.h"
+
+#include "Emulator/Logging.h"
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace emu
+{
+	namespace detail
+	{
+		// displays packing each row in a 64-bit word can be drawn a whole sprite row at a time
+		template<typename DisplayT, typename = void>
+		struct HasRowBlitter: std::false_type
+		{
+		};
+		template<typename DisplayT>
+		struct HasRowBlitter<DisplayT, std::void_t<decltype(std::declval<DisplayT&>().XorRow(std::size_t {},
+																							   std::uint64_t {}))>>
+			: std::true_type
+		{
+		};
+	}	 // namespace detail
+
+	template<typename KeypadT>
+	void Cpu::ConditionalSkipIfKeyPressed(const Opcode opcode, const KeypadT& keypad)
+	{
+		const auto Vx = opcode.x;
+		const auto keyCode = _registers[Vx];
+		LOG_DEBUG("Vx({0:d}|{0:X}) keyCode({1:d}|{1:X}|{})", Vx, keyCode, static_cast<Keys::Enum>(keyCode));
+		ConditionalSkip(keypad.IsPressed(static_cast<Keys::Enum>(keyCode)));
+	}
+
+	template<typename KeypadT>
+	void Cpu::ConditionalSkipIfKeyNotPressed(const Opcode opcode, const KeypadT& keypad)
+	{
+		const auto Vx = opcode.x;
+		const auto keyCode = _registers[Vx];
+		LOG_DEBUG("Vx({0:d}|{0:X}) keyCode({1:d}|{1:X}|{})", Vx, keyCode, static_cast<Keys::Enum>(keyCode));
+		ConditionalSkip(!keypad.IsPressed(static_cast<Keys::Enum>(keyCode)));
+	}
+
+	template<typename RamT>
+	void Cpu::LoadFontIntoIndexRegister(const Opcode opcode, const RamT& ram)
+	{
+		const auto Vx = opcode.x;
+		const auto digit = _registers[Vx];
+		LOG_DEBUG("Vx({0:d}|{0:X}) digit({1:d}|{1:X}) indexRegister({2:d}|{2:X}) <~ font({3:d}|{3:X})", Vx, digit,
+				  _indexRegister, ram.GetFontAddressAt(digit));
+		_indexRegister = ram.GetFontAddressAt(digit);
+	}
+
+	template<typename RamT>
+	void Cpu::LoadRegistersFromRam(const Opcode opcode, RamT& ram)
+	{
+		const auto Vx = opcode.x;
+		LOG_DEBUG("copying the first ({}) elements from ram(start={}) into registers", Vx + 1, _indexRegister);
+		ram.WriteTo(_indexRegister, _registers.data(), Vx + 1);
+	}
+
+	template<typename RamT>
+	void Cpu::StoreBinaryCodeRepresentation(const Opcode opcode, RamT& ram)
+	{
+		const auto Vx = opcode.x;
+		auto value = _registers[Vx];
+		LOG_TRACE("Vx({0:d}|{0:X}) regVx({1:d}|{1:X}) bcd({1:d}|{1:X})", Vx, _registers[Vx], value);
+
+		constexpr Byte base = 10;
+		// units
+		ram.SetAt(_indexRegister + 2, value % base);
+		value /= base;
+
+		// tens
+		ram.SetAt(_indexRegister + 1, value % base);
+		value /= base;
+
+		// hundreds
+		ram.SetAt(_indexRegister, value % base);
+		LOG_DEBUG(
+			"Vx({0:d}|{0:X}) regVx({1:d}|{1:X}) bcd({1:d}|{1:X}) = (h={1:d}|{1:X} | t={1:d}|{1:X} | u={1:d}|{1:X})", Vx,
+			_registers[Vx], value, ram.GetAt(_indexRegister), ram.GetAt(_indexRegister + 1),
+			ram.GetAt(_indexRegister + 2));
+	}
+
+	template<typename RamT>
+	void Cpu::StoreRegistersInRam(const Opcode opcode, RamT& ram)
+	{
+		const auto Vx = opcode.x;
+		LOG_DEBUG("storing the first ({}) elements from registers into ram(start={})", Vx + 1, _indexRegister);
+		ram.CopyFrom(_indexRegister, _registers.data(), Vx + 1);
+	}
+
+	template<typename RngT>
+	void Cpu::RandomAndEqualByte(const Opcode opcode, RngT& rng)
+	{
+		const auto Vx = opcode.x;
+		const auto kk = opcode.kk;
+		const auto random = rng.Next();
+
+		LOG_DEBUG("Vx({0:d}|{0:X}) regVx({1:d}|{1:X}) = kk({2:d}|{2:X}) & rand({3:d}|{3:X}) == {4:d}|{4:X}", Vx,
+				  _registers[Vx], kk, random, random & kk);
+		_registers[Vx] = random & kk;
+	}
+
+	template<typename DisplayT, typename RamT>
+	void Cpu::Draw(const Opcode opcode, DisplayT& display, const RamT& ram)
+	{
+		/*
+		 * Display n-byte sprite starting at memory location I at (Vx, Vy), set VF = collision.
+				The interpreter reads n bytes from memory, starting at the address stored in I.
+				These bytes are then displayed as sprites on screen at coordinates (Vx, Vy).
+				Sprites are XORed onto the existing screen.
+				If this causes any pixels to be erased, VF is set to 1, otherwise it is set to 0.
+				If the sprite is positioned so part of it is outside the coordinates of the display,
+				it wraps around to the opposite side of the screen.
+
+				See instruction 8xy3 for more information on XOR, and section 2.4, Display, for more information
+				on the Chip-8 screen and sprites.
+		 */
+		const auto Vx = opcode.x;
+		const auto Vy = opcode.y;
+		const auto n = opcode.n;
+		_registers.back() = 0;
+		LOG_TRACE(
+			"Vx({0:d}|{0:X}) regVx({1:d}|{1:X}) Vy({0:d}|{0:X}) regVy({1:d}|{1:X}) n({1:d}|{1:X}) VF({1:d}|{1:X})", Vx,
+			_registers[Vx], Vy, _registers[Vy], n, _registers.back());
+
+		// wrap x and y
+		const auto xCoord = static_cast<Byte>(_registers[Vx] % display.GetWidth());
+		const auto yCoord = static_cast<Byte>(_registers[Vy] % display.GetHeight());
+		LOG_TRACE("width({0}) height({1}) xCoord({2:d}|{2:X}) yCoord({3:d}|{3:X})", display.GetWidth(),
+				  display.GetHeight(), xCoord, yCoord);
+
+		if constexpr (detail::HasRowBlitter<DisplayT>::value)
+		{
+			assert(display.GetWidth() == 64);
+
+			// bit i of the mask is the pixel at x + i: the pixels past the right edge are rotated into the lowest
+			// bits, and they end up at the start of the next row, as with coord % (width * height)
+			const auto wrappedBits = (std::uint64_t { 1 } << xCoord) - 1;
+			bool collision = false;
+			for (size_t row = 0; row < n; ++row)
+			{
+				const auto sprite = ram.GetAt(_indexRegister + row);
+				LOG_TRACE("index({0:d}|{0:X}) row({1}) sprite({2:d}|{2:X})", _indexRegister, row, sprite);
+
+				const auto mask = utils::RotateLeft(utils::ReverseBits(sprite), xCoord);
+				const auto y = (yCoord + row) % display.GetHeight();
+				collision |= display.XorRow(y, mask & ~wrappedBits);
+				if (mask & wrappedBits)
+					collision |= display.XorRow((y + 1) % display.GetHeight(), mask & wrappedBits);
+			}
+			_registers.back() = collision;
+			return;
+		}
+
+		static constexpr size_t colSize = 8;
+		for (size_t row = 0; row < n; ++row)
+		{
+			const auto sprite = ram.GetAt(_indexRegister + row);
+			LOG_TRACE("index({0:d}|{0:X}) row({1}) sprite({2:d}|{2:X})", _indexRegister, row, sprite);
+
+			// iterate over the single bit of the sprite
+			utils::ConstexprFor<0, colSize>(
+				[&](const auto col)
+				{
+					const auto spritePixel = utils::GetBitAt<col>(sprite);
+
+					// Sprite pixel is on
+					// https://tobiasvl.github.io/blog/write-a-chip-8-emulator/
+					// the way pixels are drawn in the chip8 emulator is that 0 bits are transparent
+					// *** they do not indicate the display is off ***
+					if (!spritePixel)
+					{
+						LOG_TRACE("row({}) col({}) spritePixel is off", row, col);
+						return;
+					}
+
+					const auto coord = ((yCoord + row) * display.GetWidth() + (xCoord + col)) %
+									   (display.GetWidth() * display.GetHeight());
+					assert(coord < display.GetWidth() * display.GetHeight());
+
+					const auto screenIsOn = display.GetAt(coord);
+					_registers.back() = static_cast<Byte>(_registers.back() | screenIsOn);
+					LOG_TRACE("row({}) col({}) coord({}) screen=ON: {} collision", row, col, coord,
+							  screenIsOn ? "" : "no");
+
+					// Effectively XOR with the sprite pixel
+					LOG_DEBUG("row({}) col({}) coord({}) screen=OFF: turning on", row, col, coord);
+					display.FlipAt(coord);
+				});
+		}
+	}
+
+	template<typename KeypadT>
+	void Cpu::WaitUntilKeyIsPressed(const Opcode opcode, const KeypadT& keypad)
+	{
+		const auto Vx = opcode.x;
+
+		for (Byte i = emu::Keys::START; i < emu::Keys::END; ++i)
+		{
+			if (!keypad.IsPressed(static_cast<Keys::Enum>(i)))
+			{
+				LOG_TRACE("key({}) not pressed", static_cast<Keys::Enum>(i));
+				continue;
+			}
+
+			LOG_DEBUG("key({}) pressed: Vx({1:d}|{1:X}) regVx({2:d}|{2:X}) <~ {3:d}|{3:X}", static_cast<Keys::Enum>(i),
+					  Vx, _registers[Vx], i);
+			_registers[Vx] = i;
+			return;
+		}
+
+		// at this point, no key is pressed
+		// to simulate the wait we can just replay this instruction
+		// and since pc is always advanced, we undo this
+		LOG_TRACE("no key pressed: retreating pc expecting to re-enter here");
+		RetreatProgramCounter();
+	}
+}	 // namespace emu
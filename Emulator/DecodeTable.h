@@ -0,0 +1,46 @@
+#pragma once
+
+#include "InstructionSet.h"
+#include "Opcode.h"
+
+#include <array>
+
+namespace emu
+{
+	struct DecodedInstruction
+	{
+		// unpacked operands, ready to be passed to the Cpu
+		Opcode opcode {};
+
+		// also used as the index of the handler that executes it, Instruction::END for illegal opcodes
+		Instruction::Enum code = Instruction::END;
+	};
+
+	namespace detail
+	{
+		static constexpr std::size_t decodeTableSize = 0x10000;
+
+		static constexpr std::array<DecodedInstruction, decodeTableSize> MakeDecodeTable()
+		{
+			std::array<DecodedInstruction, decodeTableSize> ret {};
+			for (std::size_t i = 0; i < ret.size(); ++i)
+			{
+				const auto instruction = static_cast<TwoBytes>(i);
+				ret[i] = { Opcode(instruction), Decode(instruction) };
+			}
+
+			return ret;
+		}
+	}	 // namespace detail
+
+	// one entry per TwoBytes value: decoding an instruction is a single lookup. Not static, so that there's one copy in
+	// the program rather than one per translation unit
+	inline constexpr std::array<DecodedInstruction, detail::decodeTableSize> decodeTable =
+		detail::MakeDecodeTable();
+
+	static_assert(decodeTable[0x00E0].code == Instruction::_0x00E0);
+	static_assert(decodeTable[0xD12F].code == Instruction::_0xDxyn);
+	static_assert(decodeTable[0xD12F].opcode.x == 0x1 && decodeTable[0xD12F].opcode.y == 0x2 &&
+				  decodeTable[0xD12F].opcode.n == 0xF);
+	static_assert(decodeTable[0xFD68].code == Instruction::END);
+}	 // namespace emu
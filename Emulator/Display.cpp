@@ -3,21 +3,15 @@
 #include "Logging.h"
 
 #include <cassert>
+#include <cstring>
 
 namespace emu
 {
 	void Display::Clear()
 	{
 		LOG_TRACE("clearing");
-		_data.reset();
-		_hasChanged = true;
-	}
-
-	void Display::FlipAt(const std::size_t coord)
-	{
-		LOG_TRACE("coord({}) screen({} -> {})", coord, _data[coord], !_data[coord]);
-		// this is an XOR with 1
-		_data[coord] = !_data[coord];
+		std::memset(_rows.data(), 0, sizeof(_rows));
+		_dirtyRows = ~DirtyRows { 0 };
 		_hasChanged = true;
 	}
 
@@ -25,30 +19,24 @@ namespace emu
 
 	bool Display::HasChanged() const { return _hasChanged; }
 
-	bool Display::GetAt(const std::size_t coord) const
-	{
-		assert(coord < _data.size());
-		return _data[coord];
-	}
+	// on little endian machines the rows are already laid out as 'pixel i is bit (i & 7) of byte (i >> 3)'
+	static_assert(sizeof(Display::Rows) == 2048 / 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+	#error "Display serialization assumes a little endian layout"
+#endif
 
-	// https://stackoverflow.com/questions/5251403/binary-serialization-of-stdbitset
 	void Display::Serialize(std::vector<Byte>& byteArray) const
 	{
-		constexpr size_t byteSize = size / 8;
-		std::vector<Byte> localByteArray(byteSize);
-		for (size_t i = 0; i < size; ++i)
-			localByteArray[i >> 3] |= static_cast<Byte>(_data[i] << (i & 7));
-
-		byteArray.reserve(byteArray.size() + byteSize);
-		std::copy(localByteArray.begin(), localByteArray.end(), std::back_inserter(byteArray));
+		const auto offset = byteArray.size();
+		byteArray.resize(offset + sizeof(_rows));
+		std::memcpy(byteArray.data() + offset, _rows.data(), sizeof(_rows));
 	}
 
 	utils::Span<Byte> Display::Deserialize(const utils::Span<Byte>& byteArray)
 	{
-		for (size_t i = 0; i < size; ++i)
-			_data[i] = static_cast<bool>((byteArray[i >> 3] >> (i & 7)) & 1);
-
-		constexpr size_t byteSize = size / 8;
-		return utils::Span<Byte>{ byteArray.begin() + byteSize, byteArray.end() };
+		assert(byteArray.size() >= sizeof(_rows));
+		std::memcpy(_rows.data(), byteArray.begin(), sizeof(_rows));
+		_dirtyRows = ~DirtyRows { 0 };
+		return utils::Span<Byte>{ byteArray.begin() + sizeof(_rows), byteArray.end() };
 	}
 }	 // namespace emu
@@ -4,8 +4,12 @@
 #include "Interfaces/IDisplay.h"
 #include "Utilities.h"
 #include "ISerializable.h"
+#include "Logging.h"
 
-#include <bitset>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 namespace emu
@@ -17,13 +21,47 @@ namespace emu
 		static constexpr std::size_t size = width * height;
 
 	public:
+		using Rows = std::array<std::uint64_t, height>;
+		// bit y is set if row y has changed
+		using DirtyRows = std::uint32_t;
+		static_assert(sizeof(DirtyRows) * 8 == height);
+
 		[[nodiscard]] std::size_t GetWidth() const override { return width; }
 		[[nodiscard]] std::size_t GetHeight() const override { return height; }
 		void Clear() override;
 
-		[[nodiscard]] bool GetAt(const std::size_t coord) const override;
+		[[nodiscard]] bool GetAt(const std::size_t coord) const override
+		{
+			assert(coord < size);
+			return (_rows[coord / width] >> (coord % width)) & 1u;
+		}
+
+		void FlipAt(const std::size_t coord) override
+		{
+			LOG_TRACE("coord({}) screen({} -> {})", coord, GetAt(coord), !GetAt(coord));
+			// this is an XOR with 1
+			_rows[coord / width] ^= std::uint64_t { 1 } << (coord % width);
+			_dirtyRows |= DirtyRows { 1 } << (coord / width);
+			_hasChanged = true;
+		}
+
+		// row y is GetRows()[y], where bit i is the pixel at x = i
+		[[nodiscard]] utils::Span<const std::uint64_t> GetRows() const { return { _rows.begin(), _rows.end() }; }
+
+		// flips the pixels of row y set in mask (bit i is x = i): returns whether any of them was on
+		bool XorRow(const std::size_t y, const std::uint64_t mask)
+		{
+			assert(y < height);
+			auto& row = _rows[y];
+			const bool collision = (row & mask) != 0;
+			row ^= mask;
+			_dirtyRows |= static_cast<DirtyRows>(mask != 0) << y;
+			_hasChanged |= mask != 0;
+			return collision;
+		}
 
-		void FlipAt(const std::size_t coord) override;
+		// rows changed since the last call: independent of HasChanged/Reset
+		[[nodiscard]] DirtyRows ConsumeDirtyRegions() { return std::exchange(_dirtyRows, DirtyRows { 0 }); }
 
 		void Reset() override;
 		[[nodiscard]] bool HasChanged() const override;
@@ -32,7 +70,10 @@ namespace emu
 		utils::Span<Byte> Deserialize(const utils::Span<Byte>& byteArray) override;
 
 	private:
-		std::bitset<size> _data = std::bitset<size>(0);
+		// one word per row
+		static_assert(width == 64);
+		Rows _rows {};
+		DirtyRows _dirtyRows = 0;
 		bool _hasChanged = false;
 	};
 }	 // namespace emu
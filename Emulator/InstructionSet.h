@@ -245,4 +245,41 @@ namespace emu
 		}
 		static inline constexpr std::array<Instruction::Enum, 0x66> _0xFxyzInstructions = Get0xFxyzInstructionSet();
 	}	 // namespace detail
+
+	// maps an opcode to its instruction code, following the same four patterns as the tables above:
+	// illegal opcodes are mapped to Instruction::END
+	static constexpr Instruction::Enum Decode(const TwoBytes instruction)
+	{
+		// zero out the first 3 nibbles and shift it down by 12 bits
+		const auto mostSignificantBit = static_cast<Byte>((instruction & 0xF000u) >> 12u);
+		switch (mostSignificantBit)
+		{
+			case 0x0:
+			{
+				const auto lowestFourBits = utils::LowestFourBits(instruction);
+				return lowestFourBits < detail::_0x00EkInstructions.size() ? detail::_0x00EkInstructions[lowestFourBits]
+																		   : Instruction::END;
+			}
+			case 0x8:
+			{
+				const auto lowestFourBits = utils::LowestFourBits(instruction);
+				return lowestFourBits < detail::_0x80xyInstructions.size() ? detail::_0x80xyInstructions[lowestFourBits]
+																		   : Instruction::END;
+			}
+			case 0xE:
+			{
+				const auto lowestFourBits = utils::LowestFourBits(instruction);
+				return lowestFourBits < detail::_0xExyzInstructions.size() ? detail::_0xExyzInstructions[lowestFourBits]
+																		   : Instruction::END;
+			}
+			case 0xF:
+			{
+				const auto lowestByte = utils::LowestByte(instruction);
+				return lowestByte < detail::_0xFxyzInstructions.size() ? detail::_0xFxyzInstructions[lowestByte]
+																	   : Instruction::END;
+			}
+			default:
+				return detail::_uniquePatternInstructions[mostSignificantBit];
+		}
+	}
 }	 // namespace emu
@@ -0,0 +1,332 @@
+
+#include "Jit.h"
+#include "Interfaces/IRam.h"
+
+#include "Emulator/Logging.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef CHIP8_JIT_SUPPORTED
+	#include <sys/mman.h>
+#endif
+
+namespace emu
+{
+	namespace
+	{
+		/*
+		 * Generated code follows the System V calling convention:
+		 *  rdi = V0..VF, rsi = I, al and cl are used as scratch registers (caller-saved)
+		 * Every register access is a [rdi + disp8] byte operand.
+		 * */
+		class CodeEmitter
+		{
+		public:
+			// mov byte [rdi + x], kk
+			void StoreImmediate(const Byte x, const Byte kk) { Emit({ 0xC6, 0x47, x, kk }); }
+			// add byte [rdi + x], kk
+			void AddImmediate(const Byte x, const Byte kk) { Emit({ 0x80, 0x47, x, kk }); }
+
+			// mov al, [rdi + x]
+			void LoadAl(const Byte x) { Emit({ 0x8A, 0x47, x }); }
+			// mov [rdi + x], al
+			void StoreAl(const Byte x) { Emit({ 0x88, 0x47, x }); }
+			// mov [rdi + x], cl
+			void StoreCl(const Byte x) { Emit({ 0x88, 0x4F, x }); }
+
+			// op al, [rdi + y]
+			void OrAl(const Byte y) { Emit({ 0x0A, 0x47, y }); }
+			void AndAl(const Byte y) { Emit({ 0x22, 0x47, y }); }
+			void XorAl(const Byte y) { Emit({ 0x32, 0x47, y }); }
+			void AddAl(const Byte y) { Emit({ 0x02, 0x47, y }); }
+			void SubAl(const Byte y) { Emit({ 0x2A, 0x47, y }); }
+			void CompareAl(const Byte y) { Emit({ 0x3A, 0x47, y }); }
+
+			// setc cl / seta cl
+			void SetClIfCarry() { Emit({ 0x0F, 0x92, 0xC1 }); }
+			void SetClIfAbove() { Emit({ 0x0F, 0x97, 0xC1 }); }
+
+			// and al, imm8
+			void AndAlImmediate(const Byte mask) { Emit({ 0x24, mask }); }
+			// shr al, 1 / shl al, 1 / shr al, 7
+			void ShiftRightAl() { Emit({ 0xD0, 0xE8 }); }
+			void ShiftLeftAl() { Emit({ 0xD0, 0xE0 }); }
+			void ShiftRightAlBy7() { Emit({ 0xC0, 0xE8, 0x07 }); }
+
+			// mov word [rsi], nnn
+			void StoreIndexRegister(const TwoBytes nnn)
+			{
+				Emit({ 0x66, 0xC7, 0x06, utils::LowestByte(nnn), utils::HighestByte(nnn) });
+			}
+			// movzx eax, byte [rdi + x]; add word [rsi], ax
+			void AddToIndexRegister(const Byte x) { Emit({ 0x0F, 0xB6, 0x47, x, 0x66, 0x01, 0x06 }); }
+
+			// ret
+			void Return() { Emit({ 0xC3 }); }
+
+			[[nodiscard]] const auto& GetCode() const { return _code; }
+
+		private:
+			void Emit(const std::initializer_list<Byte> bytes) { _code.insert(_code.end(), bytes); }
+
+			std::vector<Byte> _code {};
+		};
+
+		constexpr Byte VF = 0xF;
+
+		TwoBytes ReadInstruction(const IRam& ram, const std::size_t address)
+		{
+			return static_cast<TwoBytes>((ram.GetAt(address) << 8u) | ram.GetAt(address + 1));
+		}
+
+		// mirrors the Cpu implementation, including the order in which VF and Vx are written: false for the instructions
+		// that aren't Jit::IsCompilable
+		bool EmitInstruction(CodeEmitter& emitter, const Instruction::Enum code, const Opcode opcode)
+		{
+			const auto x = opcode.x;
+			const auto y = opcode.y;
+			switch (code)
+			{
+				case Instruction::_0x6xkk:
+					emitter.StoreImmediate(x, opcode.kk);
+					return true;
+				case Instruction::_0x7xkk:
+					emitter.AddImmediate(x, opcode.kk);
+					return true;
+
+				case Instruction::_0x8xy0:
+					emitter.LoadAl(y);
+					emitter.StoreAl(x);
+					return true;
+				case Instruction::_0x8xy1:
+					emitter.LoadAl(x);
+					emitter.OrAl(y);
+					emitter.StoreAl(x);
+					return true;
+				case Instruction::_0x8xy2:
+					emitter.LoadAl(x);
+					emitter.AndAl(y);
+					emitter.StoreAl(x);
+					return true;
+				case Instruction::_0x8xy3:
+					emitter.LoadAl(x);
+					emitter.XorAl(y);
+					emitter.StoreAl(x);
+					return true;
+				case Instruction::_0x8xy4:
+					// the sum is computed before VF is overwritten with the carry
+					emitter.LoadAl(x);
+					emitter.AddAl(y);
+					emitter.SetClIfCarry();
+					emitter.StoreCl(VF);
+					emitter.StoreAl(x);
+					return true;
+				case Instruction::_0x8xy5:
+				case Instruction::_0x8xy7:
+				{
+					// the difference is computed after VF is overwritten with 'NOT borrow'
+					const auto reg1 = code == Instruction::_0x8xy5 ? x : y;
+					const auto reg2 = code == Instruction::_0x8xy5 ? y : x;
+					emitter.LoadAl(reg1);
+					emitter.CompareAl(reg2);
+					emitter.SetClIfAbove();
+					emitter.StoreCl(VF);
+					emitter.LoadAl(reg1);
+					emitter.SubAl(reg2);
+					emitter.StoreAl(x);
+					return true;
+				}
+				case Instruction::_0x8xy6:
+					emitter.LoadAl(x);
+					emitter.AndAlImmediate(0x01);
+					emitter.StoreAl(VF);
+					emitter.LoadAl(x);
+					emitter.ShiftRightAl();
+					emitter.StoreAl(x);
+					return true;
+				case Instruction::_0x8xyE:
+					emitter.LoadAl(x);
+					emitter.ShiftRightAlBy7();
+					emitter.StoreAl(VF);
+					emitter.LoadAl(x);
+					emitter.ShiftLeftAl();
+					emitter.StoreAl(x);
+					return true;
+
+				case Instruction::_0xAnnn:
+					emitter.StoreIndexRegister(opcode.nnn);
+					return true;
+				case Instruction::_0xFx1E:
+					emitter.AddToIndexRegister(x);
+					return true;
+
+				default:
+					return false;
+			}
+		}
+	}	 // namespace
+
+	Jit::Jit(const std::size_t codeBufferSize) : _blocks(nSlots), _states(nSlots, 0)
+	{
+#ifdef CHIP8_JIT_SUPPORTED
+		// made executable by Compile, once written
+		void* buffer = mmap(nullptr, codeBufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (buffer == MAP_FAILED)
+		{
+			LOG_ERROR("couldn't map {} bytes of code buffer: jit disabled", codeBufferSize);
+			return;
+		}
+
+		_codeBuffer = static_cast<Byte*>(buffer);
+		_codeBufferSize = codeBufferSize;
+#else
+		LOG_WARN("jit not supported on this platform (buffer size {})", codeBufferSize);
+#endif
+	}
+
+	Jit::~Jit()
+	{
+#ifdef CHIP8_JIT_SUPPORTED
+		if (_codeBuffer)
+			munmap(_codeBuffer, _codeBufferSize);
+#endif
+	}
+
+	const NativeBlock* Jit::GetColdBlock(const IRam& ram, const std::size_t address)
+	{
+		if (!IsValid())
+			return nullptr;
+
+		const auto slot = (address - addressStart) >> 1u;
+		auto& state = _states[slot];
+		// no need to wait until it's hot, when there's nothing to compile
+		if (state == 0 && (address + 1 >= ram.GetSize() || !IsCompilable(Decode(ReadInstruction(ram, address)))))
+		{
+			state = notCompilable;
+			return nullptr;
+		}
+		if (++state < hotThreshold)
+			return nullptr;
+
+		auto& block = _blocks[slot];
+		if (!Compile(ram, address, block))
+		{
+			// Compile may have flushed all the blocks, this slot included
+			_states[slot] = notCompilable;
+			return nullptr;
+		}
+
+		_states[slot] = compiled;
+		return &block;
+	}
+
+	bool Jit::Compile(const IRam& ram, const std::size_t address, NativeBlock& block)
+	{
+		CodeEmitter emitter;
+
+		const auto end = std::min(addressEnd, ram.GetSize());
+		auto pc = address;
+		Byte nCompiledInstructions = 0;
+		TwoBytes lastInstruction = 0x0;
+		auto lastInstructionCode = Instruction::END;
+		for (; nCompiledInstructions < maxBlockInstructions && pc + 1 < end; pc += 2)
+		{
+			const auto instruction = ReadInstruction(ram, pc);
+			const auto code = Decode(instruction);
+			if (!IsCompilable(code) || !EmitInstruction(emitter, code, Opcode(instruction)))
+				break;
+
+			++nCompiledInstructions;
+			lastInstruction = instruction;
+			lastInstructionCode = code;
+		}
+
+		if (nCompiledInstructions < minBlockInstructions)
+		{
+			LOG_DEBUG("block({0:d}|{0:X}) not compilable", address);
+			return false;
+		}
+		emitter.Return();
+
+		// keep every block 16-byte aligned
+		const auto& code = emitter.GetCode();
+		const auto codeSize = (code.size() + 15u) & ~std::size_t { 15 };
+		if (codeSize > _codeBufferSize)
+			return false;
+		if (_codeBufferUsed + codeSize > _codeBufferSize)
+		{
+			LOG_INFO("jit buffer full: flushing all the compiled blocks");
+			Clear();
+		}
+
+		if (!SetCodeBufferWritable(true))
+			return false;
+		auto* nativeCode = _codeBuffer + _codeBufferUsed;
+		std::memcpy(nativeCode, code.data(), code.size());
+		_codeBufferUsed += codeSize;
+		if (!SetCodeBufferWritable(false))
+			return false;
+
+		block.function = reinterpret_cast<NativeBlock::Function>(nativeCode);
+		block.startAddress = static_cast<TwoBytes>(address);
+		block.endAddress = static_cast<TwoBytes>(pc);
+		block.nInstructions = nCompiledInstructions;
+		block.lastInstruction = lastInstruction;
+		block.lastInstructionCode = lastInstructionCode;
+		++_compiledBlocks;
+
+		LOG_DEBUG("compiled block [{0:X}, {1:X}): {2} instructions, {3} bytes", address, pc, nCompiledInstructions,
+				  code.size());
+		return true;
+	}
+
+	bool Jit::SetCodeBufferWritable(const bool writable)
+	{
+#ifdef CHIP8_JIT_SUPPORTED
+		const auto protection = writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC;
+		if (mprotect(_codeBuffer, _codeBufferSize, protection) != 0)
+		{
+			LOG_ERROR("couldn't make the code buffer {}", writable ? "writable" : "executable");
+			return false;
+		}
+		return true;
+#else
+		// never mapped in the first place
+		LOG_ERROR("no code buffer to make {}", writable ? "writable" : "executable");
+		return false;
+#endif
+	}
+
+	void Jit::Invalidate(const std::size_t memoryStart, const std::size_t nElements)
+	{
+		const auto memoryEnd = memoryStart + nElements;
+
+		// only blocks starting at most maxBlockInstructions before memoryStart can overlap with it
+		const auto maxBlockSize = 2 * maxBlockInstructions;
+		const auto begin = std::max(memoryStart > maxBlockSize ? memoryStart - maxBlockSize : 0, addressStart);
+		const auto end = std::min(memoryEnd, addressEnd);
+		for (auto address = begin & ~std::size_t { 1 }; address < end; address += 2)
+		{
+			const auto slot = (address - addressStart) >> 1u;
+			auto& block = _blocks[slot];
+			if (address >= memoryStart - (memoryStart & 1u))
+				_states[slot] = 0;
+
+			if (!block.function || block.endAddress <= memoryStart)
+				continue;
+
+			LOG_DEBUG("invalidating block [{0:X}, {1:X})", block.startAddress, block.endAddress);
+			block = NativeBlock {};
+			_states[slot] = 0;
+		}
+	}
+
+	void Jit::Clear()
+	{
+		std::fill(_blocks.begin(), _blocks.end(), NativeBlock {});
+		std::fill(_states.begin(), _states.end(), Byte { 0 });
+		_codeBufferUsed = 0;
+		_compiledBlocks = 0;
+	}
+}	 // namespace emu
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "InstructionSet.h"
+#include "Opcode.h"
+#include "Types.h"
+
+#include <cstddef>
+#include <vector>
+
+// the code generator only targets x86-64 System V on Linux: anywhere else Jit::IsSupported() is false
+#if defined(__x86_64__) && defined(__linux__)
+	#define CHIP8_JIT_SUPPORTED
+#endif
+
+namespace emu
+{
+	class IRam;
+
+	// a straight-line run of instructions compiled to native code
+	struct NativeBlock
+	{
+		// registers = V0..VF, indexRegister = I: pc is updated by Cpu::ExecuteNativeBlock
+		using Function = void (*)(Byte* registers, TwoBytes* indexRegister);
+
+		Function function = nullptr;
+		TwoBytes startAddress = 0;
+		// one past the last compiled instruction, i.e. where the interpreter resumes
+		TwoBytes endAddress = 0;
+		Byte nInstructions = 0;
+
+		TwoBytes lastInstruction = 0x0;
+		Instruction::Enum lastInstructionCode = Instruction::END;
+	};
+
+	/*
+	 * Blocks start at block leaders, i.e. right after an instruction that isn't IsCompilable, and stop at the first
+	 * instruction that touches anything but V0..VF and I: jumps, calls, skips, timers, keys, Dxyn, ram loads/stores.
+	 * Those are left to the interpreter.
+	 * */
+	class Jit
+	{
+	public:
+		static constexpr std::size_t addressStart = 0x200;
+		static constexpr std::size_t addressEnd = 0x1000;
+		static constexpr std::size_t maxBlockInstructions = 64;
+		// shorter blocks are cheaper to interpret than to enter
+		static constexpr std::size_t minBlockInstructions = 2;
+		// a block is compiled only after being entered this many times
+		static constexpr Byte hotThreshold = 8;
+
+		explicit Jit(const std::size_t codeBufferSize = 1u << 20u);
+		~Jit();
+		Jit(const Jit&) = delete;
+		Jit& operator=(const Jit&) = delete;
+
+		[[nodiscard]] static constexpr bool IsSupported()
+		{
+#ifdef CHIP8_JIT_SUPPORTED
+			return true;
+#else
+			return false;
+#endif
+		}
+		[[nodiscard]] bool IsValid() const { return _codeBuffer != nullptr; }
+
+		// what the code generator handles: any other instruction ends a block
+		[[nodiscard]] static constexpr bool IsCompilable(const Instruction::Enum code)
+		{
+			switch (code)
+			{
+				case Instruction::_0x6xkk:
+				case Instruction::_0x7xkk:
+				case Instruction::_0x8xy0:
+				case Instruction::_0x8xy1:
+				case Instruction::_0x8xy2:
+				case Instruction::_0x8xy3:
+				case Instruction::_0x8xy4:
+				case Instruction::_0x8xy5:
+				case Instruction::_0x8xy6:
+				case Instruction::_0x8xy7:
+				case Instruction::_0x8xyE:
+				case Instruction::_0xAnnn:
+				case Instruction::_0xFx1E:
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		// nullptr when the block at address is not hot yet, or can't be compiled
+		[[nodiscard]] const NativeBlock* GetBlock(const IRam& ram, const std::size_t address)
+		{
+			if (address < addressStart || address >= addressEnd || (address & 1u))
+				return nullptr;
+
+			// a single byte load, as it's looked up at every block leader
+			const auto slot = (address - addressStart) >> 1u;
+			const auto state = _states[slot];
+			if (state == compiled)
+				return &_blocks[slot];
+			if (state == notCompilable)
+				return nullptr;
+
+			return GetColdBlock(ram, address);
+		}
+
+		// drops all the blocks overlapping [memoryStart, memoryStart + nElements)
+		void Invalidate(const std::size_t memoryStart, const std::size_t nElements);
+		void Clear();
+
+		[[nodiscard]] std::size_t GetCompiledBlocks() const { return _compiledBlocks; }
+
+	private:
+		const NativeBlock* GetColdBlock(const IRam& ram, const std::size_t address);
+		bool Compile(const IRam& ram, const std::size_t address, NativeBlock& block);
+		// the code buffer is never writable and executable at the same time
+		bool SetCodeBufferWritable(const bool writable);
+
+		static constexpr std::size_t nSlots = (addressEnd - addressStart) / 2;
+		// slot states, besides the hits counted up to hotThreshold
+		static constexpr Byte compiled = 0xFE;
+		static constexpr Byte notCompilable = 0xFF;
+
+		// executable memory (writable only while compiling), used as a bump allocator and reset when full
+		Byte* _codeBuffer = nullptr;
+		std::size_t _codeBufferSize = 0;
+		std::size_t _codeBufferUsed = 0;
+
+		// one slot per even address in [addressStart, addressEnd)
+		std::vector<NativeBlock> _blocks {};
+		std::vector<Byte> _states {};
+
+		std::size_t _compiledBlocks = 0;
+	};
+}	 // namespace emu
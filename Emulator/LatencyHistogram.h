@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace utils
+{
+	/*
+	 * Fixed size log-linear histogram (as HdrHistogram): values below 2 * subBuckets get a bucket each, anything
+	 * larger goes in one of subBuckets equal buckets per power of two. Recording is a couple of shifts and an
+	 * increment, percentiles are within 1 / subBuckets (6.25%) of the recorded value, for the whole uint64 range.
+	 * */
+	class LatencyHistogram
+	{
+	public:
+		static constexpr std::size_t subBuckets = 16;
+		static constexpr std::size_t nBuckets = (64 - 3) * subBuckets;
+
+		void Record(const std::uint64_t value)
+		{
+			++_buckets[GetBucket(value)];
+			++_count;
+			_sum += value;
+			_min = std::min(_min, value);
+			_max = std::max(_max, value);
+		}
+		void Clear()
+		{
+			_buckets.fill(0);
+			_count = 0;
+			_sum = 0;
+			_min = std::numeric_limits<std::uint64_t>::max();
+			_max = 0;
+		}
+
+		[[nodiscard]] std::uint64_t GetCount() const { return _count; }
+		[[nodiscard]] std::uint64_t GetMin() const { return _count > 0 ? _min : 0; }
+		[[nodiscard]] std::uint64_t GetMax() const { return _max; }
+		[[nodiscard]] double GetMean() const
+		{
+			return _count > 0 ? static_cast<double>(_sum) / static_cast<double>(_count) : 0.0;
+		}
+
+		// smallest value (up to the bucket resolution) that percentile% of the recorded ones don't exceed: 0 if empty
+		[[nodiscard]] std::uint64_t GetPercentile(const double percentile) const
+		{
+			if (_count == 0)
+				return 0;
+
+			const auto rank = std::max<std::uint64_t>(
+				1, static_cast<std::uint64_t>(percentile / 100.0 * static_cast<double>(_count) + 0.5));
+			std::uint64_t nBelow = 0;
+			for (std::size_t i = 0; i < nBuckets; ++i)
+			{
+				nBelow += _buckets[i];
+				if (nBelow >= rank)
+					return std::clamp(GetBucketUpperBound(i), GetMin(), _max);
+			}
+			return _max;
+		}
+
+		static constexpr std::size_t GetBucket(const std::uint64_t value)
+		{
+			if (value < 2 * subBuckets)
+				return static_cast<std::size_t>(value);
+			// value in [2^e, 2^(e+1)), split in subBuckets buckets of 2^(e-4)
+			const auto exponent = GetMostSignificantBit(value);
+			const auto mantissa = static_cast<std::size_t>(value >> (exponent - subBucketBits));
+			return (exponent - subBucketBits) * subBuckets + mantissa;
+		}
+		// the largest value in the bucket
+		static constexpr std::uint64_t GetBucketUpperBound(const std::size_t bucket)
+		{
+			if (bucket < 2 * subBuckets)
+				return bucket;
+			const auto shift = bucket / subBuckets - 1;
+			const auto mantissa = static_cast<std::uint64_t>(bucket % subBuckets + subBuckets);
+			return (mantissa << shift) + ((std::uint64_t { 1 } << shift) - 1);
+		}
+
+	private:
+		static constexpr std::size_t subBucketBits = 4;
+		static_assert(std::size_t { 1 } << subBucketBits == subBuckets);
+
+		static constexpr std::size_t GetMostSignificantBit(std::uint64_t value)
+		{
+			std::size_t bit = 0;
+			for (std::size_t width = 32; width > 0; width /= 2)
+			{
+				if (value >> width)
+				{
+					value >>= width;
+					bit += width;
+				}
+			}
+			return bit;
+		}
+
+		std::array<std::uint64_t, nBuckets> _buckets {};
+		std::uint64_t _count = 0;
+		std::uint64_t _sum = 0;
+		std::uint64_t _min = std::numeric_limits<std::uint64_t>::max();
+		std::uint64_t _max = 0;
+	};
+}	 // namespace utils
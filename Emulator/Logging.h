@@ -35,12 +35,23 @@ __STOP_IGNORING_WARNINGS__
 		#define LOG_DEBUG(...) SPDLOG_DEBUG(__VA_ARGS__)
 		#define LOG_TRACE(...) SPDLOG_TRACE(__VA_ARGS__)
 	#else
-		#define LOG_CRITICAL(...) SPDLOG_LOGGER_CRITICAL(spdlog::get(LOGGER_NAME), __VA_ARGS__)
-		#define LOG_ERROR(...) SPDLOG_LOGGER_ERROR(spdlog::get(LOGGER_NAME), __VA_ARGS__)
-		#define LOG_WARN(...) SPDLOG_LOGGER_WARN(spdlog::get(LOGGER_NAME), __VA_ARGS__)
-		#define LOG_INFO(...) SPDLOG_LOGGER_INFO(spdlog::get(LOGGER_NAME), __VA_ARGS__)
-		#define LOG_DEBUG(...) SPDLOG_LOGGER_DEBUG(spdlog::get(LOGGER_NAME), __VA_ARGS__)
-		#define LOG_TRACE(...) SPDLOG_LOGGER_TRACE(spdlog::get(LOGGER_NAME), __VA_ARGS__)
+namespace utils::detail
+{
+	// spdlog::get locks the logger registry: LOGGER_NAME is looked up only once, so it has to be registered before
+	// anything is logged. One per translation unit, as LOGGER_NAME can differ
+	static inline spdlog::logger* GetLogger()
+	{
+		static const auto logger = spdlog::get(LOGGER_NAME);
+		return logger.get();
+	}
+}	 // namespace utils::detail
+
+		#define LOG_CRITICAL(...) SPDLOG_LOGGER_CRITICAL(utils::detail::GetLogger(), __VA_ARGS__)
+		#define LOG_ERROR(...) SPDLOG_LOGGER_ERROR(utils::detail::GetLogger(), __VA_ARGS__)
+		#define LOG_WARN(...) SPDLOG_LOGGER_WARN(utils::detail::GetLogger(), __VA_ARGS__)
+		#define LOG_INFO(...) SPDLOG_LOGGER_INFO(utils::detail::GetLogger(), __VA_ARGS__)
+		#define LOG_DEBUG(...) SPDLOG_LOGGER_DEBUG(utils::detail::GetLogger(), __VA_ARGS__)
+		#define LOG_TRACE(...) SPDLOG_LOGGER_TRACE(utils::detail::GetLogger(), __VA_ARGS__)
 	#endif
 #else
 	#define LOG_CRITICAL(...) static_cast<void>(0)
@@ -66,6 +77,8 @@ namespace detail
 	{
 	public:
 		auto& GetRingBuffer() { return _ringBuffer; }
+		// to be held while reading the ring buffer, if other threads are logging
+		auto& GetMutex() { return spdlog::sinks::base_sink<Mutex>::mutex_; }
 
 	protected:
 		void sink_it_(const spdlog::details::log_msg& msg) override
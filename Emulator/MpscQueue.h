@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace utils
+{
+	/*
+	 * Bounded lock-free queue for any number of producer threads and exactly one consumer thread: N must be a power
+	 * of 2. Each slot has a sequence number telling whether it's free for the producer of position p (== p) or ready
+	 * for the consumer (== p + 1), so that producers only contend on the position.
+	 * See https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+	 * */
+	template<typename T, std::size_t N>
+	class MpscQueue
+	{
+		static_assert(N >= 2 && (N & (N - 1)) == 0);
+		static_assert(std::atomic<std::size_t>::is_always_lock_free);
+
+	public:
+		MpscQueue()
+		{
+			for (std::size_t i = 0; i < N; ++i)
+				_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] constexpr std::size_t MaxSize() const { return N; }
+
+		// any thread: false if the queue is full
+		template<typename S>
+		bool TryPush(S&& item)
+		{
+			auto position = _tail.load(std::memory_order_relaxed);
+			while (true)
+			{
+				auto& slot = _slots[position & indexMask];
+				const auto lag = static_cast<std::ptrdiff_t>(slot.sequence.load(std::memory_order_acquire) - position);
+				if (lag == 0)
+				{
+					if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						slot.item = std::forward<S>(item);
+						slot.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				// not consumed yet since the previous lap
+				else if (lag < 0)
+					return false;
+				// another producer took it
+				else
+					position = _tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		// consumer only: false if the queue is empty, or if the next item is still being written
+		bool TryPop(T& item)
+		{
+			const auto position = _head.load(std::memory_order_relaxed);
+			auto& slot = _slots[position & indexMask];
+			if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+				return false;
+
+			item = std::move(slot.item);
+			slot.sequence.store(position + N, std::memory_order_release);
+			_head.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// only a hint while other threads are running
+		[[nodiscard]] bool Empty() const
+		{
+			return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		static constexpr std::size_t indexMask = N - 1;
+		static constexpr std::size_t cacheLineSize = 64;
+
+		struct Slot
+		{
+			std::atomic<std::size_t> sequence { 0 };
+			T item {};
+		};
+		std::array<Slot, N> _slots {};
+		// on separate cache lines, so that the producers and the consumer don't keep invalidating each other's
+		alignas(cacheLineSize) std::atomic<std::size_t> _head { 0 };
+		alignas(cacheLineSize) std::atomic<std::size_t> _tail { 0 };
+	};
+}	 // namespace utils
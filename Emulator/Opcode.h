@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Types.h"
+#include "Utilities.h"
+
+namespace emu
+{
+	/*
+	 *  http://devernay.free.fr/hacks/chip8/C8TECH10.HTM#3.0
+	 *  An instruction split into all of its possible operands, so that they're extracted only once at decode time.
+	 *  Not all of them are meaningful for a given instruction: e.g. 1nnn only uses nnn.
+	 */
+	struct Opcode
+	{
+		constexpr Opcode() = default;
+
+		// implicit on purpose: a raw instruction can be used wherever an Opcode is expected
+		constexpr Opcode(const TwoBytes instruction_)	 // NOLINT(google-explicit-constructor)
+			: instruction(instruction_),
+			  nnn(utils::LowerTwelveBits(instruction_)),
+			  x(utils::LowerFourBitsHighByte(instruction_)),
+			  y(utils::UpperFourBitsLowByte(instruction_)),
+			  n(utils::LowestFourBits(instruction_)),
+			  kk(utils::LowestByte(instruction_))
+		{
+		}
+
+		TwoBytes instruction = 0;
+		TwoBytes nnn = 0;
+		Byte x = 0;
+		Byte y = 0;
+		Byte n = 0;
+		Byte kk = 0;
+	};
+}	 // namespace emu
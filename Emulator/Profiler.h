@@ -0,0 +1,50 @@
+#pragma once
+
+#include "InstructionSet.h"
+#include "Types.h"
+
+#include <array>
+#include <cstdint>
+
+// per instruction counters and host cycles, see Chip8::GetProfile: cmake -DCHIP8_PROFILER=ON
+#ifdef CHIP8_PROFILER
+	#include "TimeStampCounter.h"
+#endif
+
+namespace emu
+{
+	struct InstructionProfile
+	{
+		std::uint64_t count = 0;
+		// utils::ReadTimeStampCounter ticks spent executing it, dispatch excluded
+		std::uint64_t hostCycles = 0;
+	};
+
+	struct Profile
+	{
+		static constexpr std::size_t addressSpaceSize = 0x1000;
+
+		// indexed by Instruction::Enum: Instruction::END counts the illegal ones
+		std::array<InstructionProfile, nInstructions> instructions {};
+		// instructions fetched at each address
+		std::array<std::uint64_t, addressSpaceSize> programCounterHits {};
+
+		void Add(const Instruction::Enum code, const std::size_t programCounter, const std::uint64_t hostCycles)
+		{
+			++instructions[code].count;
+			instructions[code].hostCycles += hostCycles;
+			++programCounterHits[programCounter & (addressSpaceSize - 1)];
+		}
+
+		[[nodiscard]] InstructionProfile GetTotal() const
+		{
+			InstructionProfile total;
+			for (const auto& instruction : instructions)
+			{
+				total.count += instruction.count;
+				total.hostCycles += instruction.hostCycles;
+			}
+			return total;
+		}
+	};
+}	 // namespace emu
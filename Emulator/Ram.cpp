@@ -15,14 +15,6 @@ namespace emu
 		CopyFrom(fontsOffset, fonts.data(), fonts.size());
 	}
 
-	void Ram::SetAt(const size_t index, const Byte value)
-	{
-		assert(index >= Ram::instructionStart);
-		LOG_DEBUG("ram[{0:d}|{0:X}] = {1}", index, value);
-
-		_data[index] = value;
-	}
-
 	void Ram::Load(const std::string& buffer)
 	{
 		LOG_DEBUG("loaded from buffer, size({})", buffer.size());
@@ -4,6 +4,7 @@
 #include "Types.h"
 #include "Interfaces/IRam.h"
 #include "ISerializable.h"
+#include "Logging.h"
 
 #include <array>
 #include <cstring>
@@ -67,7 +68,13 @@ namespace emu
 		{
 			return _data[index];
 		}
-		void SetAt(const size_t index, const Byte value) override;
+		void SetAt(const size_t index, const Byte value) override
+		{
+			assert(index >= Ram::instructionStart);
+			LOG_DEBUG("ram[{0:d}|{0:X}] = {1}", index, value);
+
+			_data[index] = value;
+		}
 		void CopyFrom(const size_t memoryStart, const Byte* source, const size_t nElements) override;
 		void WriteTo(const size_t memoryStart, Byte* dest, const size_t nElements) const override;
 
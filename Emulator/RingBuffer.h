@@ -68,7 +68,7 @@ namespace utils
 			assert(_head + i - MaxSize() <= _tail);
 			return _data[_head + i - MaxSize()];
 		}
-		const T& operator[](const std::size_t i) const { return this->operator[](i); }
+		const T& operator[](const std::size_t i) const { return const_cast<RingBuffer&>(*this)[i]; }
 
 		[[nodiscard]] T& Front() { return this->operator[](0); }
 		[[nodiscard]] T& Back() { return this->operator[](Size() - 1); }
@@ -14,6 +14,9 @@ namespace emu
 	{
 	}
 
-	Byte Rng::Next() { return _distribution(_generator); }
-
+	void Rng::Seed(unsigned int seed)
+	{
+		_generator.seed(seed);
+		_distribution.reset();
+	}
 }	 // namespace emu
@@ -21,7 +21,9 @@ namespace emu
 
 		explicit Rng();
 
-		[[nodiscard]] Byte Next() override;
+		[[nodiscard]] Byte Next() override { return _distribution(_generator); }
+		// same sequence as Rng(seed)
+		void Seed(unsigned int seed);
 
 	private:
 		std::random_device _device{};
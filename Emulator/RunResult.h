@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace emu
+{
+	// why a batched run (RunCycles/RunFrame/RunUntil) returned
+	namespace StopReason
+	{
+		enum Enum
+		{
+			START = 0,
+			// all the requested cycles have been executed
+			None = START,
+			Error,
+			Breakpoint,
+			// Fx0A with no key pressed: it would be replayed until a key is pressed
+			WaitingForKey,
+			// only when requested
+			DisplayChanged,
+			Predicate,
+			END,
+		};
+	}	 // namespace StopReason
+
+	static inline std::string_view ToString(StopReason::Enum stopReason)
+	{
+		switch (stopReason)
+		{
+			case StopReason::None:
+				return "None";
+			case StopReason::Error:
+				return "Error";
+			case StopReason::Breakpoint:
+				return "Breakpoint";
+			case StopReason::WaitingForKey:
+				return "Waiting for key";
+			case StopReason::DisplayChanged:
+				return "Display changed";
+			case StopReason::Predicate:
+				return "Predicate";
+			default:
+				return "?";
+		}
+	}
+
+	template<typename OStream>
+	OStream& operator<<(OStream& os, const StopReason::Enum stopReason)
+	{
+		return os << ToString(stopReason);
+	}
+
+	struct RunResult
+	{
+		std::size_t cycles = 0;
+		StopReason::Enum stopReason = StopReason::None;
+		// Dxyn or 00E0 has been executed
+		bool displayChanged = false;
+	};
+}	 // namespace emu
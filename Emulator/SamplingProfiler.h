@@ -0,0 +1,102 @@
+#pragma once
+
+#include "InstructionSet.h"
+#include "Interfaces/IRam.h"
+#include "Types.h"
+
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace emu
+{
+	/*
+	 * Guest sampling profiler: every period instructions, the guest call stack and pc are counted, so that hot
+	 * subroutines can be found in a flame graph (https://github.com/brendangregg/FlameGraph):
+	 *  main;sub_2A0;sub_310;0x316 42
+	 * is 42 samples at pc 0x316, in the subroutine at 0x310 called from the one at 0x2A0. Subroutines are named after
+	 * the target of the 2nnn that called them, read back from ram at sampling time.
+	 * */
+	class SamplingProfiler
+	{
+	public:
+		// prime, so that it's unlikely to be in lockstep with the guest loops
+		static constexpr std::size_t defaultPeriod = 997;
+
+		explicit SamplingProfiler(const std::size_t period = defaultPeriod) : _period(period > 0 ? period : 1) {}
+
+		[[nodiscard]] std::size_t GetPeriod() const { return _period; }
+		[[nodiscard]] std::size_t GetCyclesToNextSample() const { return _period - _phase; }
+		// after nCycles more instructions: true when a sample is due
+		bool Advance(const std::size_t nCycles)
+		{
+			_phase += nCycles;
+			if (_phase < _period)
+				return false;
+			_phase %= _period;
+			return true;
+		}
+
+		// stack has the return addresses of the depth active calls, outermost first
+		void Sample(const TwoBytes* stack, const std::size_t depth, const TwoBytes programCounter, const IRam& ram)
+		{
+			_frames.clear();
+			for (std::size_t i = 0; i < depth; ++i)
+				_frames.push_back(GetCallTarget(stack[i], ram));
+			_frames.push_back(programCounter);
+
+			auto it = _samples.find(_frames);
+			if (it == _samples.end())
+				it = _samples.emplace(_frames, 0).first;
+			++it->second;
+			++_nSamples;
+		}
+
+		[[nodiscard]] std::size_t GetSampleCount() const { return _nSamples; }
+
+		// one "frame;...;frame count" line per distinct stack
+		void WriteFolded(std::ostream& os) const
+		{
+			char label[16];
+			for (const auto& [frames, count] : _samples)
+			{
+				os << "main";
+				for (std::size_t i = 0; i + 1 < frames.size(); ++i)
+				{
+					if (frames[i] == unknownTarget)
+						os << ";sub_unknown";
+					else
+					{
+						std::snprintf(label, sizeof(label), ";sub_%03X", frames[i]);
+						os << label;
+					}
+				}
+				std::snprintf(label, sizeof(label), ";0x%03X", frames.back());
+				os << label << " " << count << "\n";
+			}
+		}
+
+	private:
+		// not a valid address, so that it can't be mistaken for one
+		static constexpr TwoBytes unknownTarget = 0xFFFF;
+
+		// where the 2nnn right before returnAddress jumped to: unknownTarget if it's not a 2nnn (anymore)
+		static TwoBytes GetCallTarget(const TwoBytes returnAddress, const IRam& ram)
+		{
+			if (returnAddress < 2 || returnAddress > ram.GetSize())
+				return unknownTarget;
+			const auto instruction =
+				static_cast<TwoBytes>((ram.GetAt(returnAddress - 2u) << 8u) | ram.GetAt(returnAddress - 1u));
+			return Decode(instruction) == Instruction::_0x2nnn ? static_cast<TwoBytes>(instruction & 0x0FFFu)
+															   : unknownTarget;
+		}
+
+		std::size_t _period;
+		std::size_t _phase = 0;
+		std::size_t _nSamples = 0;
+		// outermost call target first, pc last
+		std::map<std::vector<TwoBytes>, std::size_t> _samples {};
+		std::vector<TwoBytes> _frames {};
+	};
+}	 // namespace emu
@@ -53,6 +53,8 @@ namespace utils
 
 		[[nodiscard]] constexpr auto Size() const { return _length; }
 
+		[[nodiscard]] constexpr T* data() const noexcept { return _data; }
+
 		[[nodiscard]] constexpr T* begin() const { return _data; }
 		[[nodiscard]] constexpr T* begin() { return _data; }
 
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace utils
+{
+	// lock-free queue for exactly one producer thread and one consumer thread: N must be a power of 2, and one slot
+	// is always left empty to tell a full queue from an empty one
+	template<typename T, std::size_t N>
+	class SpscQueue
+	{
+		static_assert(N >= 2 && (N & (N - 1)) == 0);
+		static_assert(std::atomic<std::size_t>::is_always_lock_free);
+
+	public:
+		[[nodiscard]] constexpr std::size_t MaxSize() const { return N - 1; }
+
+		// producer only: false if the queue is full
+		template<typename S>
+		bool TryPush(S&& item)
+		{
+			const auto tail = _tail.load(std::memory_order_relaxed);
+			const auto next = (tail + 1) & indexMask;
+			if (next == _head.load(std::memory_order_acquire))
+				return false;
+
+			_data[tail] = std::forward<S>(item);
+			_tail.store(next, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only: false if the queue is empty
+		bool TryPop(T& item)
+		{
+			const auto head = _head.load(std::memory_order_relaxed);
+			if (head == _tail.load(std::memory_order_acquire))
+				return false;
+
+			item = std::move(_data[head]);
+			_head.store((head + 1) & indexMask, std::memory_order_release);
+			return true;
+		}
+
+		// only a hint while the other thread is running
+		[[nodiscard]] bool Empty() const
+		{
+			return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		static constexpr std::size_t indexMask = N - 1;
+		static constexpr std::size_t cacheLineSize = 64;
+
+		std::array<T, N> _data {};
+		// on separate cache lines, so that the producer and the consumer don't keep invalidating each other's
+		alignas(cacheLineSize) std::atomic<std::size_t> _head { 0 };
+		alignas(cacheLineSize) std::atomic<std::size_t> _tail { 0 };
+	};
+}	 // namespace utils
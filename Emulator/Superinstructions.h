@@ -0,0 +1,76 @@
+#pragma once
+
+#include "InstructionSet.h"
+
+#include <array>
+#include <string_view>
+
+namespace emu
+{
+	// common instruction sequences, executed as a single fused handler
+	namespace Superinstruction
+	{
+		enum Enum
+		{
+			START = 0,
+			// Annn, Dxyn: set I, then draw
+			SetIndexAndDraw = START,
+			// Fx07, 3xkk, 1nnn: busy-waiting on the delay timer
+			PollDelayTimer,
+			// 7xkk, 3xkk: loop counter
+			AddAndSkipIfEqual,
+
+			END,
+		};
+	}	 // namespace Superinstruction
+
+	static constexpr std::size_t nSuperinstructions = Superinstruction::END;
+	// instructions spanned by each superinstruction: at most as many are executed
+	static constexpr std::array<std::size_t, nSuperinstructions> superinstructionLengths = { { 2, 3, 2 } };
+	static constexpr std::size_t maxSuperinstructionLength = 3;
+	static constexpr std::array<std::string_view, nSuperinstructions + 1> superinstructionIds = {
+		{ "Annn+Dxyn", "Fx07+3xkk+1nnn", "7xkk+3xkk", "NONE" }
+	};
+
+	static constexpr inline std::string_view ToString(const Superinstruction::Enum superinstruction)
+	{
+		return superinstructionIds[static_cast<size_t>(superinstruction)];
+	}
+
+	// whether a known sequence begins with this instruction
+	static constexpr bool StartsSuperinstruction(const Instruction::Enum first)
+	{
+		return first == Instruction::_0xAnnn || first == Instruction::_0xFx07 || first == Instruction::_0x7xkk;
+	}
+
+	// Superinstruction::END if the three instructions starting at pc don't begin with a known sequence
+	static constexpr Superinstruction::Enum MatchSuperinstruction(const Instruction::Enum first,
+																  const Instruction::Enum second,
+																  const Instruction::Enum third)
+	{
+		if (first == Instruction::_0xAnnn && second == Instruction::_0xDxyn)
+			return Superinstruction::SetIndexAndDraw;
+		if (first == Instruction::_0xFx07 && second == Instruction::_0x3xkk && third == Instruction::_0x1nnn)
+			return Superinstruction::PollDelayTimer;
+		if (first == Instruction::_0x7xkk && second == Instruction::_0x3xkk)
+			return Superinstruction::AddAndSkipIfEqual;
+
+		return Superinstruction::END;
+	}
+
+	struct SuperinstructionStatistics
+	{
+		std::array<std::size_t, nSuperinstructions> fired {};
+		// each firing replaces one dispatch per fused instruction, but the first
+		std::size_t dispatchesSaved = 0;
+	};
+
+	template<typename OStream>
+	OStream& operator<<(OStream& os, const SuperinstructionStatistics& statistics)
+	{
+		for (size_t i = Superinstruction::START; i < Superinstruction::END; ++i)
+			os << ToString(static_cast<Superinstruction::Enum>(i)) << ": " << statistics.fired[i] << "\n";
+		os << "dispatches saved: " << statistics.dispatchesSaved << "\n";
+		return os;
+	}
+}	 // namespace emu
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "RingBuffer.h"
+#include "TimeStampCounter.h"
+
+#include <cstdint>
+
+namespace utils
+{
+	/*
+	 * Items per second over the batches done in the last windowSeconds, rather than over the last batch alone: a
+	 * batch that was preempted, or that ran into a slow instruction, doesn't make the rate jump. Times are time stamp
+	 * counter ticks, as measured by TscStopWatch.
+	 * */
+	class ThroughputMeter
+	{
+	public:
+		// the window is shortened whenever it holds more batches than this
+		static constexpr std::size_t maxBatches = 1024;
+
+		explicit ThroughputMeter(const double windowSeconds = 1.0)
+			: _windowTicks(static_cast<std::uint64_t>(windowSeconds * GetTimeStampCounterFrequency()))
+		{
+		}
+
+		// nItems done in busyTicks, by the time endTicks
+		void Add(const std::uint64_t nItems, const std::uint64_t busyTicks,
+				 const std::uint64_t endTicks = ReadTimeStampCounter())
+		{
+			while (_batches.Size() > 0 &&
+				   (_batches.Size() == maxBatches || endTicks - _batches.Front().endTicks > _windowTicks))
+				Pop();
+
+			_batches.PushBack(Batch { nItems, busyTicks, endTicks });
+			_nItems += nItems;
+			_busyTicks += busyTicks;
+		}
+		void Clear()
+		{
+			_batches.Clear();
+			_nItems = 0;
+			_busyTicks = 0;
+		}
+
+		// 0 until something's been measured
+		[[nodiscard]] double GetItemsPerSecond() const
+		{
+			if (_busyTicks == 0)
+				return 0.0;
+			return static_cast<double>(_nItems) * GetTimeStampCounterFrequency() / static_cast<double>(_busyTicks);
+		}
+
+	private:
+		struct Batch
+		{
+			std::uint64_t nItems = 0;
+			std::uint64_t busyTicks = 0;
+			std::uint64_t endTicks = 0;
+		};
+
+		void Pop()
+		{
+			const auto batch = _batches.PopFront();
+			_nItems -= batch.nItems;
+			_busyTicks -= batch.busyTicks;
+		}
+
+		std::uint64_t _windowTicks;
+		RingBuffer<Batch, maxBatches> _batches {};
+		std::uint64_t _nItems = 0;
+		std::uint64_t _busyTicks = 0;
+	};
+}	 // namespace utils
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+#endif
+
+namespace utils
+{
+	// host cycles: a fixed frequency counter that costs a few ns to read, not serializing. Wherever there's no such
+	// counter, nanoseconds from the steady clock
+	static inline std::uint64_t ReadTimeStampCounter()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#elif defined(__aarch64__)
+		std::uint64_t ticks;
+		asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+		return ticks;
+#else
+		return static_cast<std::uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+				.count());
+#endif
+	}
+
+	// as ReadTimeStampCounter, once everything before it has executed: where a measurement ends
+	static inline std::uint64_t ReadTimeStampCounterAfterPrevious()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		unsigned int processorId;
+		return __rdtscp(&processorId);
+#elif defined(__aarch64__)
+		asm volatile("isb" ::: "memory");
+		return ReadTimeStampCounter();
+#else
+		return ReadTimeStampCounter();
+#endif
+	}
+
+	// ticks per second: measured against the steady clock the first time, which takes calibrationTime. Not static,
+	// so that it's calibrated once per process rather than once per translation unit
+	inline double GetTimeStampCounterFrequency()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		static const double frequency = []
+		{
+			static constexpr auto calibrationTime = std::chrono::milliseconds(20);
+
+			const auto start = std::chrono::steady_clock::now();
+			const auto startTicks = ReadTimeStampCounter();
+			auto end = start;
+			while (end - start < calibrationTime)
+				end = std::chrono::steady_clock::now();
+			const auto endTicks = ReadTimeStampCounter();
+
+			return static_cast<double>(endTicks - startTicks) / std::chrono::duration<double>(end - start).count();
+		}();
+		return frequency;
+#elif defined(__aarch64__)
+		std::uint64_t frequency;
+		asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+		return static_cast<double>(frequency);
+#else
+		return 1e9;
+#endif
+	}
+}	 // namespace utils
@@ -0,0 +1,107 @@
+#include "Trace.h"
+
+#include "Emulator/Logging.h"
+
+#include <algorithm>
+#include <fstream>
+#include <new>
+
+#ifdef CHIP8_TRACE_SUPPORTED
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+namespace emu
+{
+	TraceRecorder::~TraceRecorder() { Close(); }
+
+	bool TraceRecorder::Open(const std::filesystem::path& path, const std::size_t capacity)
+	{
+		Close();
+		if (capacity == 0)
+		{
+			LOG_ERROR("trace({}) needs room for at least one record", path.string());
+			return false;
+		}
+
+#ifdef CHIP8_TRACE_SUPPORTED
+		const auto fileDescriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fileDescriptor < 0)
+		{
+			LOG_ERROR("trace({}) couldn't be created", path.string());
+			return false;
+		}
+
+		const auto mappedSize = sizeof(TraceFileHeader) + capacity * sizeof(TraceRecord);
+		void* buffer = MAP_FAILED;
+		if (ftruncate(fileDescriptor, static_cast<off_t>(mappedSize)) == 0)
+			buffer = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+		// the mapping keeps the file open
+		close(fileDescriptor);
+		if (buffer == MAP_FAILED)
+		{
+			LOG_ERROR("trace({}) couldn't be mapped ({} bytes)", path.string(), mappedSize);
+			return false;
+		}
+
+		_header = new (buffer) TraceFileHeader {};
+		_header->capacity = capacity;
+		_records = reinterpret_cast<TraceRecord*>(_header + 1);
+		_position = 0;
+		_mappedSize = mappedSize;
+		return true;
+#else
+		LOG_ERROR("trace({}) not supported on this platform", path.string());
+		return false;
+#endif
+	}
+
+	void TraceRecorder::Close()
+	{
+#ifdef CHIP8_TRACE_SUPPORTED
+		if (_header)
+			munmap(_header, _mappedSize);
+#endif
+		_header = nullptr;
+		_records = nullptr;
+		_position = 0;
+		_mappedSize = 0;
+	}
+
+	bool ReadTrace(const std::filesystem::path& path, std::vector<TraceRecord>& records)
+	{
+		records.clear();
+
+		std::ifstream file(path, std::ios::binary);
+		TraceFileHeader header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		{
+			LOG_ERROR("trace({}) couldn't be read", path.string());
+			return false;
+		}
+		if (header.magic != TraceFileHeader::expectedMagic || header.version != TraceFileHeader::currentVersion ||
+			header.recordSize != sizeof(TraceRecord) || header.capacity == 0)
+		{
+			LOG_ERROR("trace({}) is not a trace file, or was written by a different version", path.string());
+			return false;
+		}
+
+		const auto nRecords = static_cast<std::size_t>(std::min(header.nRecords, header.capacity));
+		std::vector<TraceRecord> buffer(nRecords);
+		if (!file.read(reinterpret_cast<char*>(buffer.data()),
+					   static_cast<std::streamsize>(nRecords * sizeof(TraceRecord))))
+		{
+			LOG_ERROR("trace({}) is truncated", path.string());
+			return false;
+		}
+
+		// oldest first: once wrapped around, the oldest record is the one to be overwritten next
+		const auto oldest =
+			header.nRecords > header.capacity ? static_cast<std::size_t>(header.nRecords % header.capacity) : 0;
+		records.reserve(nRecords);
+		records.insert(records.end(), buffer.begin() + static_cast<std::ptrdiff_t>(oldest), buffer.end());
+		records.insert(records.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(oldest));
+		return true;
+	}
+}	 // namespace emu
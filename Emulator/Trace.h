@@ -0,0 +1,137 @@
+#pragma once
+
+#include "InstructionSet.h"
+#include "Types.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// the recorder maps the file in memory, which is only implemented with POSIX mmap: anywhere else Open() fails
+#if defined(__unix__) || defined(__APPLE__)
+	#define CHIP8_TRACE_SUPPORTED
+#endif
+
+namespace emu
+{
+	// one executed instruction, as it was right after executing it
+	struct TraceRecord
+	{
+		// instructions traced before this one
+		std::uint64_t cycle = 0;
+		// where the instruction was fetched from
+		TwoBytes programCounter = 0;
+		TwoBytes instruction = 0;
+		TwoBytes indexRegister = 0;
+		// noRegister when the instruction doesn't write any of V0..VF
+		Byte registerIndex = 0;
+		Byte registerValue = 0;
+
+		static constexpr Byte noRegister = 0xFF;
+	};
+	static_assert(sizeof(TraceRecord) == 16);
+
+	/*
+	 * Trace file layout, in native byte order: a TraceFileHeader followed by capacity TraceRecord's. Records are
+	 * written circularly, so that the file always holds the last capacity instructions: the oldest one is at
+	 * nRecords % capacity once it has wrapped around.
+	 * */
+	struct TraceFileHeader
+	{
+		static constexpr std::array<char, 8> expectedMagic = { 'C', 'H', '8', 'T', 'R', 'A', 'C', 'E' };
+		static constexpr std::uint32_t currentVersion = 1;
+
+		std::array<char, 8> magic = expectedMagic;
+		std::uint32_t version = currentVersion;
+		std::uint32_t recordSize = sizeof(TraceRecord);
+		std::uint64_t capacity = 0;
+		// ever recorded, including the overwritten ones
+		std::uint64_t nRecords = 0;
+	};
+	static_assert(sizeof(TraceFileHeader) == 32);
+
+	// which of V0..VF the instruction writes: the x operand, VF for Dxyn, TraceRecord::noRegister for none (and for an
+	// Fx0A still waiting for a key, which stores nothing)
+	static constexpr Byte GetWrittenRegister(const Instruction::Enum code, const TwoBytes instruction,
+											 const bool waitingForKey = false)
+	{
+		switch (code)
+		{
+			case Instruction::_0xFx0A:
+				return waitingForKey ? TraceRecord::noRegister : static_cast<Byte>((instruction & 0x0F00u) >> 8u);
+			case Instruction::_0x6xkk:
+			case Instruction::_0x7xkk:
+			case Instruction::_0x8xy0:
+			case Instruction::_0x8xy1:
+			case Instruction::_0x8xy2:
+			case Instruction::_0x8xy3:
+			case Instruction::_0x8xy4:
+			case Instruction::_0x8xy5:
+			case Instruction::_0x8xy6:
+			case Instruction::_0x8xy7:
+			case Instruction::_0x8xyE:
+			case Instruction::_0xCxkk:
+			case Instruction::_0xFx07:
+			case Instruction::_0xFx65:
+				return static_cast<Byte>((instruction & 0x0F00u) >> 8u);
+			case Instruction::_0xDxyn:
+				return 0xF;
+			default:
+				return TraceRecord::noRegister;
+		}
+	}
+
+	/*
+	 * Binary instruction trace, written straight into a memory mapped file: recording an instruction is a 16 bytes
+	 * store, with no formatting and no system calls. The file is complete (up to the last record) even if the process
+	 * dies, as the kernel writes the mapped pages back on its own.
+	 * */
+	class TraceRecorder
+	{
+	public:
+		// 16MB
+		static constexpr std::size_t defaultCapacity = 1u << 20u;
+
+		TraceRecorder() = default;
+		~TraceRecorder();
+		TraceRecorder(const TraceRecorder&) = delete;
+		TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+		[[nodiscard]] static constexpr bool IsSupported()
+		{
+#ifdef CHIP8_TRACE_SUPPORTED
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		// creates (or truncates) path, large enough for capacity records
+		bool Open(const std::filesystem::path& path, const std::size_t capacity = defaultCapacity);
+		void Close();
+		[[nodiscard]] bool IsOpen() const { return _header != nullptr; }
+
+		void Record(const TwoBytes programCounter, const TwoBytes instruction, const TwoBytes indexRegister,
+					const Byte registerIndex, const Byte registerValue)
+		{
+			_records[_position] = { _header->nRecords, programCounter, instruction,
+									indexRegister, registerIndex, registerValue };
+			++_header->nRecords;
+			if (++_position == _header->capacity)
+				_position = 0;
+		}
+
+		[[nodiscard]] std::uint64_t GetRecordCount() const { return _header ? _header->nRecords : 0; }
+
+	private:
+		TraceFileHeader* _header = nullptr;
+		TraceRecord* _records = nullptr;
+		std::size_t _position = 0;
+		std::size_t _mappedSize = 0;
+	};
+
+	// the records still in a trace file, oldest first: false if it's not a valid trace file
+	bool ReadTrace(const std::filesystem::path& path, std::vector<TraceRecord>& records);
+}	 // namespace emu
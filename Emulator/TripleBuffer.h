@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace utils
+{
+	// lock-free hand-over of the latest T from one producer thread to one consumer thread: the producer always has
+	// a buffer of its own to write into, the consumer always reads a whole published one, and neither ever waits
+	template<typename T>
+	class TripleBuffer
+	{
+		static_assert(std::atomic<std::uint8_t>::is_always_lock_free);
+
+	public:
+		// producer only: write into it, then Publish
+		[[nodiscard]] T& GetBackBuffer() { return _buffers[_back]; }
+		// producer only: the back buffer becomes the latest one, replacing what the consumer hasn't picked up yet
+		void Publish()
+		{
+			const auto previous = _middle.exchange(static_cast<std::uint8_t>(_back | newBit), std::memory_order_acq_rel);
+			_back = previous & indexMask;
+		}
+
+		// consumer only: moves to the latest published buffer, returning false if there's none since the last call
+		bool Update()
+		{
+			if ((_middle.load(std::memory_order_relaxed) & newBit) == 0)
+				return false;
+			_front = _middle.exchange(_front, std::memory_order_acq_rel) & indexMask;
+			return true;
+		}
+		// consumer only
+		[[nodiscard]] const T& GetFrontBuffer() const { return _buffers[_front]; }
+
+	private:
+		// the middle buffer index, plus whether it's been published since the consumer last took it
+		static constexpr std::uint8_t indexMask = 0x3;
+		static constexpr std::uint8_t newBit = 0x4;
+
+		std::array<T, 3> _buffers {};
+		std::uint8_t _back = 0;
+		std::atomic<std::uint8_t> _middle { 1 };
+		std::uint8_t _front = 2;
+	};
+}	 // namespace utils
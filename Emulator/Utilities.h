@@ -4,6 +4,7 @@
 #include "Types.h"
 #include <type_traits>
 #include <array>
+#include <cstdint>
 
 namespace utils
 {
@@ -101,4 +102,49 @@ namespace utils
 		constexpr emu::TwoBytes mask = 0x0080u >> index;
 		return static_cast<emu::Byte>(detail::Mask(instruction, mask));
 	}
+
+	// most significant bit <-> least significant bit
+	static constexpr emu::Byte ReverseBits(emu::Byte value)
+	{
+		value = static_cast<emu::Byte>(((value & 0xF0u) >> 4u) | ((value & 0x0Fu) << 4u));
+		value = static_cast<emu::Byte>(((value & 0xCCu) >> 2u) | ((value & 0x33u) << 2u));
+		return static_cast<emu::Byte>(((value & 0xAAu) >> 1u) | ((value & 0x55u) << 1u));
+	}
+	static_assert(ReverseBits(0x80) == 0x01 && ReverseBits(0xA4) == 0x25);
+
+	// shift in [0, 64): compiles down to a single rol
+	static constexpr std::uint64_t RotateLeft(const std::uint64_t value, const unsigned shift)
+	{
+		return (value << shift) | (value >> ((64u - shift) & 63u));
+	}
+
+	// FNV-1a: e.g. to compare states across runs
+	static constexpr std::uint64_t Fnv1a(const emu::Byte* const data, const std::size_t size,
+										 std::uint64_t hash = 0xcbf29ce484222325ull)
+	{
+		for (std::size_t i = 0; i < size; ++i)
+			hash = (hash ^ data[i]) * 0x100000001b3ull;
+		return hash;
+	}
+
+	// out[i] = all ones if bit i is set, 0 otherwise: branchless and with a constant mask per lane rather than a
+	// variable shift, so that it's vectorized even without AVX2
+	template<typename T>
+	static inline void ExpandBits(const std::uint64_t bits, T* const out)
+	{
+		static_assert(std::is_unsigned_v<T>);
+		constexpr auto masks = []
+		{
+			std::array<std::uint32_t, 32> ret {};
+			for (unsigned i = 0; i < ret.size(); ++i)
+				ret[i] = 1u << i;
+			return ret;
+		}();
+
+		const std::array<std::uint32_t, 2> halves = { static_cast<std::uint32_t>(bits),
+													   static_cast<std::uint32_t>(bits >> 32u) };
+		for (unsigned h = 0; h < halves.size(); ++h)
+			for (unsigned i = 0; i < masks.size(); ++i)
+				out[masks.size() * h + i] = (halves[h] & masks[i]) != 0 ? static_cast<T>(~T { 0 }) : T { 0 };
+	}
 }	 // namespace utils
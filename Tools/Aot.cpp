@@ -0,0 +1,311 @@
+
+#include "Emulator/InstructionSet.h"
+#include "Emulator/Opcode.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * chip8-aot: statically recompiles a ROM into a C++ translation unit, with one function per basic block.
+ *
+ * The control flow graph is recovered starting from 0x200, following fall-throughs, jumps, calls and skips.
+ * What can't be resolved statically (Bnnn, and 00EE when it returns somewhere unexpected) lands on an address with
+ * no block: the runtime (Tools/AotRuntime.h) then falls back to the interpreter until it reaches a known block again.
+ * */
+namespace
+{
+	using emu::Byte;
+	using emu::TwoBytes;
+	namespace Instruction = emu::Instruction;
+
+	constexpr std::size_t romStart = 0x200;
+	constexpr std::size_t ramSize = 0x1000;
+
+	struct DecodedInstruction
+	{
+		TwoBytes address = 0;
+		TwoBytes instruction = 0;
+		Instruction::Enum code = Instruction::END;
+	};
+
+	struct BasicBlock
+	{
+		TwoBytes start = 0;
+		TwoBytes end = 0;
+		std::vector<DecodedInstruction> instructions {};
+	};
+
+	bool IsSkip(const Instruction::Enum code)
+	{
+		switch (code)
+		{
+			case Instruction::_0x3xkk:
+			case Instruction::_0x4xkk:
+			case Instruction::_0x5xy0:
+			case Instruction::_0x9xy0:
+			case Instruction::_0xExA1:
+			case Instruction::_0xEx9E:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	// the last instruction of a block: control flow, and ram writes (which might modify code)
+	bool IsTerminator(const Instruction::Enum code)
+	{
+		switch (code)
+		{
+			case Instruction::_0x00EE:
+			case Instruction::_0x1nnn:
+			case Instruction::_0x2nnn:
+			case Instruction::_0xBnnn:
+			case Instruction::_0xFx0A:
+			case Instruction::_0xFx33:
+			case Instruction::_0xFx55:
+			case Instruction::END:
+				return true;
+			default:
+				return IsSkip(code);
+		}
+	}
+
+	class Recompiler
+	{
+	public:
+		explicit Recompiler(std::vector<Byte> rom) : _rom(std::move(rom)) {}
+
+		void RecoverControlFlowGraph()
+		{
+			std::vector<std::size_t> worklist = { romStart };
+			_leaders.insert(romStart);
+			while (!worklist.empty())
+			{
+				const auto address = worklist.back();
+				worklist.pop_back();
+				if (!IsInRom(address) || _reachable.count(address))
+					continue;
+				_reachable.insert(address);
+
+				const auto decoded = DecodeAt(address);
+				const auto next = address + 2;
+				const auto addLeader = [&](const std::size_t target)
+				{
+					_leaders.insert(target);
+					worklist.push_back(target);
+				};
+
+				if (decoded.code == Instruction::_0x1nnn)
+					addLeader(emu::Opcode(decoded.instruction).nnn);
+				else if (decoded.code == Instruction::_0x2nnn)
+				{
+					// 00EE comes back right after the call
+					addLeader(emu::Opcode(decoded.instruction).nnn);
+					addLeader(next);
+				}
+				else if (IsSkip(decoded.code))
+				{
+					addLeader(next);
+					addLeader(next + 2);
+				}
+				else if (decoded.code == Instruction::_0xFx0A)
+				{
+					// replayed until a key is pressed
+					addLeader(address);
+					addLeader(next);
+				}
+				else if (decoded.code == Instruction::_0x00EE || decoded.code == Instruction::_0xBnnn ||
+						 decoded.code == Instruction::END)
+					continue;
+				else if (IsTerminator(decoded.code))
+					addLeader(next);
+				else
+					worklist.push_back(next);
+			}
+
+			for (const auto leader : _leaders)
+			{
+				if (!_reachable.count(leader))
+					continue;
+
+				BasicBlock block;
+				block.start = static_cast<TwoBytes>(leader);
+				auto address = leader;
+				do
+				{
+					block.instructions.push_back(DecodeAt(address));
+					address += 2;
+				} while (!IsTerminator(block.instructions.back().code) && _reachable.count(address) &&
+						 !_leaders.count(address));
+				block.end = static_cast<TwoBytes>(address);
+
+				_blocks.push_back(std::move(block));
+			}
+		}
+
+		void Emit(std::ostream& out, const std::string& romName) const
+		{
+			out << "// generated by chip8-aot from " << romName << ": do not edit\n";
+			out << "// " << _blocks.size() << " basic blocks, " << _reachable.size() << " reachable instructions\n\n";
+			out << "#include \"Tools/AotRuntime.h\"\n\n";
+			out << "namespace\n{\n";
+
+			EmitRom(out);
+			EmitCodeRanges(out);
+
+			for (const auto& block : _blocks)
+				EmitBlock(out, block);
+
+			out << "\ttemplate<typename Chip8T>\n";
+			out << "\temu::aot::Block<Chip8T> Lookup(const emu::TwoBytes programCounter)\n";
+			out << "\t{\n";
+			out << "\t\tswitch (programCounter)\n";
+			out << "\t\t{\n";
+			for (const auto& block : _blocks)
+			{
+				out << "\t\t\tcase " << Hex(block.start) << ":\n";
+				out << "\t\t\t\treturn { Block" << Hex(block.start) << "<Chip8T>, " << block.instructions.size()
+					<< " };\n";
+			}
+			out << "\t\t\tdefault:\n";
+			out << "\t\t\t\treturn {};\n";
+			out << "\t\t}\n";
+			out << "\t}\n";
+			out << "}\t // namespace\n\n";
+
+			out << "int main(int argc, char** argv)\n";
+			out << "{\n";
+			out << "\treturn emu::aot::Main(argc, argv, std::string_view(reinterpret_cast<const char*>(rom.data()), "
+				   "rom.size()), codeRanges, Lookup<emu::aot::StaticChip8<>>);\n";
+			out << "}\n";
+		}
+
+	private:
+		[[nodiscard]] bool IsInRom(const std::size_t address) const
+		{
+			return address >= romStart && address + 1 < romStart + _rom.size();
+		}
+
+		[[nodiscard]] DecodedInstruction DecodeAt(const std::size_t address) const
+		{
+			const auto instruction =
+				static_cast<TwoBytes>((_rom[address - romStart] << 8u) | _rom[address + 1 - romStart]);
+			return { static_cast<TwoBytes>(address), instruction, emu::Decode(instruction) };
+		}
+
+		static std::string Hex(const std::size_t value, const int width = 3)
+		{
+			std::ostringstream os;
+			os << "0x" << std::uppercase << std::hex;
+			os.width(width);
+			os.fill('0');
+			os << value;
+			return os.str();
+		}
+
+		static std::string EnumName(const Instruction::Enum code)
+		{
+			if (code == Instruction::END)
+				return "emu::Instruction::END";
+			return "emu::Instruction::_" + std::string(emu::ToString(code));
+		}
+
+		void EmitRom(std::ostream& out) const
+		{
+			out << "\tconstexpr std::array<unsigned char, " << _rom.size() << "> rom = {";
+			for (std::size_t i = 0; i < _rom.size(); ++i)
+				out << (i % 16 == 0 ? "\n\t\t" : " ") << Hex(_rom[i], 2) << ",";
+			out << "\n\t};\n\n";
+		}
+
+		void EmitCodeRanges(std::ostream& out) const
+		{
+			// adjacent blocks are merged
+			std::vector<std::pair<std::size_t, std::size_t>> ranges;
+			for (const auto& block : _blocks)
+			{
+				if (!ranges.empty() && ranges.back().second >= block.start)
+					ranges.back().second = std::max<std::size_t>(ranges.back().second, block.end);
+				else
+					ranges.emplace_back(block.start, block.end);
+			}
+
+			out << "\tconst emu::aot::CodeRanges codeRanges = {\n";
+			for (const auto& [start, end] : ranges)
+				out << "\t\t{ " << Hex(start) << ", " << Hex(end) << " },\n";
+			out << "\t};\n\n";
+		}
+
+		static void EmitBlock(std::ostream& out, const BasicBlock& block)
+		{
+			out << "\t// [" << Hex(block.start) << ", " << Hex(block.end) << ")\n";
+			out << "\ttemplate<typename Chip8T>\n";
+			out << "\tstd::size_t Block" << Hex(block.start) << "(Chip8T& chip8)\n";
+			out << "\t{\n";
+			for (std::size_t i = 0; i < block.instructions.size(); ++i)
+			{
+				const auto& decoded = block.instructions[i];
+				out << "\t\t// " << Hex(decoded.address) << ": " << Hex(decoded.instruction, 4) << " ("
+					<< emu::ToString(decoded.code) << ")\n";
+				out << "\t\tif (!chip8.template Execute<" << EnumName(decoded.code) << ">(" << Hex(decoded.instruction, 4)
+					<< "))\n";
+				out << "\t\t\treturn " << i << ";\n";
+
+				if (decoded.code == Instruction::_0xFx33)
+					out << "\t\tchip8.CheckWrite(3);\n";
+				else if (decoded.code == Instruction::_0xFx55)
+					out << "\t\tchip8.CheckWrite(" << emu::Opcode(decoded.instruction).x + 1 << ");\n";
+			}
+			out << "\t\treturn " << block.instructions.size() << ";\n";
+			out << "\t}\n\n";
+		}
+
+		std::vector<Byte> _rom;
+		std::set<std::size_t> _leaders {};
+		std::set<std::size_t> _reachable {};
+		std::vector<BasicBlock> _blocks {};
+	};
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		std::cerr << "usage: chip8-aot <rom> <output.cpp>" << std::endl;
+		return 1;
+	}
+
+	const std::filesystem::path romPath = argv[1];
+	std::ifstream romFile(romPath, std::ios::binary);
+	if (!romFile.is_open())
+	{
+		std::cerr << "couldn't open " << romPath << std::endl;
+		return 1;
+	}
+
+	std::vector<Byte> rom { std::istreambuf_iterator<char>(romFile), std::istreambuf_iterator<char>() };
+	if (rom.empty() || rom.size() > ramSize - romStart)
+	{
+		std::cerr << romPath << ": invalid rom size(" << rom.size() << ")" << std::endl;
+		return 1;
+	}
+
+	Recompiler recompiler(std::move(rom));
+	recompiler.RecoverControlFlowGraph();
+
+	std::ofstream output(argv[2]);
+	if (!output.is_open())
+	{
+		std::cerr << "couldn't open " << argv[2] << std::endl;
+		return 1;
+	}
+	recompiler.Emit(output, romPath.filename().string());
+
+	return 0;
+}
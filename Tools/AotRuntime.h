@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Emulator/Chip8.h"
+#include "Emulator/Logging.h"
+#include "Emulator/Stopwatch.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// support code for the translation units generated by chip8-aot
+namespace emu::aot
+{
+	// [start, end) of the statically recompiled instructions
+	using CodeRanges = std::vector<std::pair<TwoBytes, TwoBytes>>;
+
+	template<typename CpuT = Cpu, typename RngT = Rng, typename RamT = Ram, typename DisplayT = Display,
+			 typename KeypadT = Keypad>
+	class StaticChip8: public detail::Chip8<CpuT, RngT, RamT, DisplayT, KeypadT>
+	{
+	public:
+		StaticChip8(const std::string_view rom, CodeRanges codeRanges) : _codeRanges(std::move(codeRanges))
+		{
+			this->_ram.Load(std::string(rom));
+		}
+
+		template<Instruction::Enum instructionCode>
+		bool Execute(const TwoBytes instruction)
+		{
+			return this->template CycleStatic<instructionCode>(Opcode(instruction));
+		}
+
+		// the interpreter fallback, one instruction at a time even with superinstructions enabled: its ram writes are
+		// checked as well, e.g. an Fx55 reached through Bnnn
+		bool Cycle()
+		{
+			if (this->Dispatch(1) == 0)
+				return false;
+
+			if (this->GetLastExecutedInstructionCode() == Instruction::_0xFx33)
+				CheckWrite(3);
+			else if (this->GetLastExecutedInstructionCode() == Instruction::_0xFx55)
+				CheckWrite(Opcode(this->GetLastExecutedInstruction()).x + 1u);
+			return true;
+		}
+
+		// to be called after Fx33/Fx55: once the program writes over its own code, the compiled blocks are stale
+		void CheckWrite(const std::size_t nElements)
+		{
+			const std::size_t start = this->_cpu.GetIndexRegister();
+			for (const auto& [codeStart, codeEnd] : _codeRanges)
+			{
+				if (_selfModified || start >= codeEnd || start + nElements <= codeStart)
+					continue;
+
+				LOG_WARN("ram[{0:X}, {1:X}) overwrites code in [{2:X}, {3:X}): falling back to the interpreter", start,
+						 start + nElements, codeStart, codeEnd);
+				_selfModified = true;
+			}
+		}
+		[[nodiscard]] bool IsSelfModified() const { return _selfModified; }
+
+	private:
+		CodeRanges _codeRanges {};
+		bool _selfModified = false;
+	};
+
+	template<typename Chip8T>
+	struct Block
+	{
+		std::size_t (*function)(Chip8T&) = nullptr;
+		std::size_t nInstructions = 0;
+	};
+	// maps the program counter to the block starting there, if any
+	template<typename Chip8T>
+	using BlockLookup = Block<Chip8T> (*)(const TwoBytes programCounter);
+
+	struct RunStatistics
+	{
+		std::size_t cycles = 0;
+		std::size_t interpretedCycles = 0;
+	};
+
+	// runs nCycles instructions (unless an error occurs), falling back to the interpreter where there's no block
+	template<typename Chip8T>
+	RunStatistics Run(Chip8T& chip8, const BlockLookup<Chip8T> lookup, const std::size_t nCycles)
+	{
+		RunStatistics statistics;
+		while (statistics.cycles < nCycles && chip8.IsValid())
+		{
+			if (!chip8.IsSelfModified())
+			{
+				const auto block = lookup(chip8.GetCpu().GetProgramCounter());
+				if (block.function && block.nInstructions <= nCycles - statistics.cycles)
+				{
+					statistics.cycles += block.function(chip8);
+					continue;
+				}
+			}
+
+			if (!chip8.Cycle())
+				break;
+			++statistics.cycles;
+			++statistics.interpretedCycles;
+		}
+
+		return statistics;
+	}
+
+	struct Options
+	{
+		std::size_t nCycles = 10'000'000;
+		unsigned int seed = 0;
+		bool interpretOnly = false;
+	};
+
+	inline void PrintUsage(const char* executable)
+	{
+		std::fprintf(stderr,
+					 "usage: %s [options] [nCycles]\n"
+					 "  nCycles          instructions to run (default 10000000)\n"
+					 "  --interpret      run without the compiled blocks, e.g. to compare the state hashes\n"
+					 "  --seed N         random number generator seed (default 0)\n",
+					 executable);
+	}
+
+	// throws std::invalid_argument or std::out_of_range on malformed numbers, e.g. "abc"
+	inline bool ParseOptionsOrThrow(const int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view arg = argv[i];
+			if (arg == "--interpret")
+				options.interpretOnly = true;
+			else if (arg == "--seed" && i + 1 < argc)
+				options.seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+			else if (arg.rfind("--", 0) == 0)
+				return false;
+			else
+				options.nCycles = std::stoull(argv[i]);
+		}
+
+		return true;
+	}
+
+	// false on unknown options and malformed values
+	inline bool ParseOptions(const int argc, char** argv, Options& options)
+	{
+		try
+		{
+			return ParseOptionsOrThrow(argc, argv, options);
+		}
+		catch (const std::logic_error&)
+		{
+			// the usage is printed instead
+			return false;
+		}
+	}
+
+	// from a freshly seeded state, so that compiled and interpreted runs can be compared through the state hash
+	template<typename Chip8T = StaticChip8<>>
+	int Main(int argc, char** argv, const std::string_view rom, const CodeRanges& codeRanges,
+			 const BlockLookup<Chip8T> lookup)
+	{
+		Options options;
+		if (!ParseOptions(argc, argv, options))
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+
+		spdlog::set_level(spdlog::level::warn);
+		Chip8T chip8(rom, codeRanges);
+		chip8.GetRng().Seed(options.seed);
+
+		utils::StopWatch sw;
+		const auto statistics = options.interpretOnly
+									? RunStatistics { chip8.RunCyclesThroughKeyWaits(options.nCycles).cycles, 0 }
+									: Run(chip8, lookup, options.nCycles);
+		sw.Stop();
+
+		// of the whole serialized state, to compare runs
+		std::vector<Byte> state;
+		chip8.Serialize(state);
+		const auto hash = utils::Fnv1a(state.data(), state.size());
+
+		std::printf("cycles: %zu\n", statistics.cycles);
+		std::printf("interpreted cycles: %zu\n", statistics.interpretedCycles);
+		std::printf("self modified: %s\n", chip8.IsSelfModified() ? "yes" : "no");
+		std::printf("error: %s\n", ToString(chip8.GetLastError()).data());
+		std::printf("seconds: %.6f\n", sw.GetSeconds());
+		std::printf("Mcycles/s: %.3f\n", static_cast<double>(statistics.cycles) / sw.GetMicroSeconds());
+		std::printf("state hash: %016llx\n", static_cast<unsigned long long>(hash));
+
+		return chip8.IsValid() ? 0 : 1;
+	}
+}	 // namespace emu::aot
@@ -0,0 +1,32 @@
+# runs a statically recompiled ROM with and without its compiled blocks: the final states must be the same
+# cmake -DEXECUTABLE=<add_chip8_aot executable> -DCYCLES=<n> [-DSELF_MODIFIED=ON] -P AotTest.cmake
+
+foreach(mode compiled interpreted)
+	if (mode STREQUAL "interpreted")
+		set(modeArguments --interpret)
+	endif()
+	execute_process(
+		COMMAND
+			${EXECUTABLE} ${CYCLES} ${modeArguments}
+		RESULT_VARIABLE
+			result
+		OUTPUT_VARIABLE
+			output
+	)
+	message("${mode}:\n${output}")
+	if (NOT result EQUAL 0)
+		message(FATAL_ERROR "${EXECUTABLE} failed (${result})")
+	endif()
+
+	string(REGEX MATCH "state hash: ([0-9a-f]+)" ignored ${output})
+	set(${mode}Hash ${CMAKE_MATCH_1})
+	string(REGEX MATCH "self modified: ([a-z]+)" ignored ${output})
+	set(${mode}SelfModified ${CMAKE_MATCH_1})
+endforeach()
+
+if (NOT compiledHash OR NOT compiledHash STREQUAL interpretedHash)
+	message(FATAL_ERROR "state hash: ${compiledHash} compiled, ${interpretedHash} interpreted")
+endif()
+if (SELF_MODIFIED AND NOT compiledSelfModified STREQUAL "yes")
+	message(FATAL_ERROR "the ROM overwrites its code, but that went undetected")
+endif()
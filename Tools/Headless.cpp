@@ -0,0 +1,381 @@
+#include "Emulator/Chip8.h"
+#include "Emulator/Logging.h"
+#include "Emulator/Stopwatch.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * chip8-headless: runs ROMs with no window, and prints what happened as JSON.
+ *
+ * Each ROM runs for the same number of cycles (or frames, i.e. 60Hz worth of cycles at the configured speed) from a
+ * freshly seeded state, so that runs are reproducible and can be compared through the display and state hashes.
+ * Key presses can be scripted, one "<frame> <key> <down|up>" per line, e.g. "120 5 down", applied at the start of
+ * the given frame.
+ * */
+namespace
+{
+	struct KeyEvent
+	{
+		std::size_t frame = 0;
+		emu::Keys::Enum key = emu::Keys::END;
+		bool pressed = false;
+	};
+
+	struct Options
+	{
+		std::vector<std::string> roms {};
+		std::size_t nCycles = 10'000'000;
+		std::optional<std::size_t> nFrames {};
+		std::size_t instructionsPerSecond = 600;
+		unsigned int seed = 0;
+		bool useJit = false;
+		bool useSuperinstructions = false;
+		bool useInstructionCache = true;
+		std::vector<KeyEvent> keyEvents {};
+		std::string tracePath {};
+		std::size_t traceCapacity = emu::TraceRecorder::defaultCapacity;
+		std::string foldedPath {};
+		std::size_t samplePeriod = emu::SamplingProfiler::defaultPeriod;
+	};
+
+	struct RunStatistics
+	{
+		std::size_t cycles = 0;
+		std::size_t frames = 0;
+		double seconds = 0.0;
+	};
+
+	void PrintUsage()
+	{
+		std::cerr << "usage: chip8-headless [options] <rom>...\n"
+					 "  --cycles N       instructions to run (default 10000000)\n"
+					 "  --frames N       frames to run instead, i.e. N * speed / 60 instructions\n"
+					 "  --speed N        instructions per second (default 600)\n"
+					 "  --input FILE     scripted key presses, one \"<frame> <key 0-F> <down|up>\" per line\n"
+					 "                   (# starts a comment)\n"
+					 "  --seed N         random number generator seed (default 0)\n"
+					 "  --jit            enable the jit\n"
+					 "  --superinstructions\n"
+					 "                   enable superinstructions\n"
+					 "  --no-cache       disable the instruction cache\n"
+					 "  --trace FILE     record a binary trace of the last instructions, see chip8-trace\n"
+					 "                   (FILE.<n> for the n-th ROM, when there's more than one)\n"
+					 "  --trace-capacity N\n"
+					 "                   instructions kept in the trace (default 1048576)\n"
+					 "  --folded FILE    sample the guest call stack, and write it as folded stacks for flamegraph.pl\n"
+					 "                   (FILE.<n> for the n-th ROM, when there's more than one)\n"
+					 "  --sample-period N\n"
+					 "                   instructions between samples (default 997)\n";
+	}
+
+	bool ParseKeyEvents(const std::string& path, std::vector<KeyEvent>& keyEvents)
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
+		{
+			std::cerr << "couldn't open " << path << std::endl;
+			return false;
+		}
+
+		std::string line;
+		for (std::size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+		{
+			line = line.substr(0, line.find('#'));
+			if (line.find_first_not_of(" \t\r") == std::string::npos)
+				continue;
+
+			std::istringstream is(line);
+			KeyEvent keyEvent;
+			unsigned int key = emu::Keys::END;
+			std::string state;
+			if (!(is >> keyEvent.frame >> std::hex >> key >> state) || key >= emu::Keys::END ||
+				(state != "down" && state != "up"))
+			{
+				std::cerr << path << ":" << lineNumber << ": expected \"<frame> <key 0-F> <down|up>\"" << std::endl;
+				return false;
+			}
+			keyEvent.key = static_cast<emu::Keys::Enum>(key);
+			keyEvent.pressed = state == "down";
+			keyEvents.push_back(keyEvent);
+		}
+
+		std::stable_sort(keyEvents.begin(), keyEvents.end(),
+						 [](const auto& lhs, const auto& rhs) { return lhs.frame < rhs.frame; });
+		return true;
+	}
+
+	// throws std::invalid_argument or std::out_of_range on malformed numbers, e.g. "--cycles abc"
+	bool ParseOptionsOrThrow(const int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			const auto hasValue = i + 1 < argc;
+			if (arg == "--cycles" && hasValue)
+				options.nCycles = std::stoull(argv[++i]);
+			else if (arg == "--frames" && hasValue)
+				options.nFrames = std::stoull(argv[++i]);
+			else if (arg == "--speed" && hasValue)
+				options.instructionsPerSecond = std::stoull(argv[++i]);
+			else if (arg == "--seed" && hasValue)
+				options.seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+			else if (arg == "--input" && hasValue)
+			{
+				if (!ParseKeyEvents(argv[++i], options.keyEvents))
+					return false;
+			}
+			else if (arg == "--trace" && hasValue)
+				options.tracePath = argv[++i];
+			else if (arg == "--trace-capacity" && hasValue)
+				options.traceCapacity = std::stoull(argv[++i]);
+			else if (arg == "--folded" && hasValue)
+				options.foldedPath = argv[++i];
+			else if (arg == "--sample-period" && hasValue)
+				options.samplePeriod = std::stoull(argv[++i]);
+			else if (arg == "--jit")
+				options.useJit = true;
+			else if (arg == "--superinstructions")
+				options.useSuperinstructions = true;
+			else if (arg == "--no-cache")
+				options.useInstructionCache = false;
+			else if (arg.rfind("--", 0) == 0)
+				return false;
+			else
+				options.roms.push_back(arg);
+		}
+
+		return !options.roms.empty();
+	}
+
+	// false on unknown options and malformed values
+	bool ParseOptions(const int argc, char** argv, Options& options)
+	{
+		try
+		{
+			return ParseOptionsOrThrow(argc, argv, options);
+		}
+		catch (const std::logic_error&)
+		{
+			// the usage is printed instead
+			return false;
+		}
+	}
+
+	// path as is for a single ROM, path.<romIndex> otherwise
+	std::string GetOutputPath(const std::string& path, const std::size_t romIndex, const std::size_t nRoms)
+	{
+		return nRoms > 1 ? path + "." + std::to_string(romIndex) : path;
+	}
+
+	// runs up to the next scripted key event in a single batch
+	RunStatistics Run(emu::Chip8& chip8, const Options& options)
+	{
+		const auto cyclesPerFrame = chip8.GetCyclesPerFrame();
+		const auto nCycles = options.nFrames ? *options.nFrames * cyclesPerFrame : options.nCycles;
+
+		RunStatistics statistics;
+		auto keyEvent = options.keyEvents.begin();
+		utils::StopWatch sw;
+		while (statistics.cycles < nCycles && chip8.IsValid())
+		{
+			const auto frame = statistics.cycles / cyclesPerFrame;
+			for (; keyEvent != options.keyEvents.end() && keyEvent->frame <= frame; ++keyEvent)
+				chip8.GetKeypad().Press(keyEvent->key, keyEvent->pressed);
+
+			auto end = nCycles;
+			if (keyEvent != options.keyEvents.end())
+				end = std::min(end, keyEvent->frame * cyclesPerFrame);
+
+			const auto cycles = chip8.RunCyclesThroughKeyWaits(end - statistics.cycles).cycles;
+			statistics.cycles += cycles;
+			if (cycles == 0)
+				break;
+		}
+		sw.Stop();
+
+		statistics.frames = statistics.cycles / cyclesPerFrame;
+		statistics.seconds = sw.GetSeconds();
+		return statistics;
+	}
+
+	std::string JsonString(const std::string& str)
+	{
+		std::string ret = "\"";
+		for (const auto c : str)
+		{
+			if (c == '"' || c == '\\')
+				ret += '\\';
+			ret += c;
+		}
+		return ret + "\"";
+	}
+
+	std::string Hex(const std::uint64_t value)
+	{
+		char buffer[17];
+		std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+		return buffer;
+	}
+
+	// only what has been executed: instructions by host cycles, addresses in ascending order
+	void PrintProfileJson(std::ostream& os, const emu::Profile& profile)
+	{
+		std::vector<emu::Instruction::Enum> codes;
+		for (auto code = emu::Instruction::START; code <= emu::Instruction::END;
+			 code = static_cast<emu::Instruction::Enum>(code + 1))
+		{
+			if (profile.instructions[code].count > 0)
+				codes.push_back(code);
+		}
+		std::stable_sort(codes.begin(), codes.end(),
+						 [&](const auto lhs, const auto rhs)
+						 { return profile.instructions[lhs].hostCycles > profile.instructions[rhs].hostCycles; });
+
+		const auto total = profile.GetTotal();
+		os << "      \"profile\": {\n";
+		os << "        \"instructions\": " << total.count << ",\n";
+		os << "        \"hostCycles\": " << total.hostCycles << ",\n";
+		os << "        \"perInstruction\": [";
+		for (std::size_t i = 0; i < codes.size(); ++i)
+		{
+			const auto& instruction = profile.instructions[codes[i]];
+			os << (i > 0 ? "," : "") << "\n          { \"id\": " << JsonString(std::string(emu::ToString(codes[i])))
+			   << ", \"method\": " << JsonString(std::string(emu::cpuInstructionMapping[codes[i]]))
+			   << ", \"count\": " << instruction.count << ", \"hostCycles\": " << instruction.hostCycles
+			   << ", \"hostCyclesPerInstruction\": "
+			   << static_cast<double>(instruction.hostCycles) / static_cast<double>(instruction.count) << " }";
+		}
+		os << "\n        ],\n";
+		// [address, hits] pairs
+		os << "        \"programCounterHits\": [";
+		bool first = true;
+		for (std::size_t address = 0; address < profile.programCounterHits.size(); ++address)
+		{
+			if (profile.programCounterHits[address] == 0)
+				continue;
+			os << (first ? "" : ", ") << "[" << address << ", " << profile.programCounterHits[address] << "]";
+			first = false;
+		}
+		os << "]\n";
+		os << "      }";
+	}
+
+	void PrintJson(std::ostream& os, const std::string& rom, const emu::Chip8& chip8, const Options& options,
+				   const RunStatistics& statistics)
+	{
+		const auto& rows = chip8.GetDisplay().GetRows();
+		const auto displayHash =
+			utils::Fnv1a(reinterpret_cast<const emu::Byte*>(rows.data()), rows.size() * sizeof(rows[0]));
+
+		std::vector<emu::Byte> state;
+		chip8.Serialize(state);
+		const auto stateHash = utils::Fnv1a(state.data(), state.size());
+
+		const auto emulatedSeconds =
+			static_cast<double>(statistics.cycles) / static_cast<double>(chip8.GetInstructionsPerSecond());
+		// JSON has no infinity
+		const auto seconds = std::max(statistics.seconds, 1e-9);
+		const auto& cpu = chip8.GetCpu();
+
+		os << "    {\n";
+		os << "      \"rom\": " << JsonString(rom) << ",\n";
+		os << "      \"error\": " << JsonString(std::string(emu::ToString(chip8.GetLastError()))) << ",\n";
+		os << "      \"instructionsPerSecond\": " << chip8.GetInstructionsPerSecond() << ",\n";
+		os << "      \"seed\": " << options.seed << ",\n";
+		os << "      \"cycles\": " << statistics.cycles << ",\n";
+		os << "      \"frames\": " << statistics.frames << ",\n";
+		os << "      \"seconds\": " << statistics.seconds << ",\n";
+		os << "      \"cyclesPerSecond\": " << static_cast<double>(statistics.cycles) / seconds << ",\n";
+		os << "      \"speedMultiple\": " << emulatedSeconds / seconds << ",\n";
+		os << "      \"displayHash\": \"" << Hex(displayHash) << "\",\n";
+		os << "      \"stateHash\": \"" << Hex(stateHash) << "\",\n";
+		os << "      \"state\": {\n";
+		os << "        \"pc\": " << cpu.GetProgramCounter() << ",\n";
+		os << "        \"i\": " << cpu.GetIndexRegister() << ",\n";
+		os << "        \"sp\": " << static_cast<unsigned>(cpu.GetStackPointer()) << ",\n";
+		os << "        \"delayTimer\": " << static_cast<unsigned>(cpu.GetDelayTimer()) << ",\n";
+		os << "        \"soundTimer\": " << static_cast<unsigned>(cpu.GetSoundTimer()) << ",\n";
+		os << "        \"registers\": [";
+		for (std::size_t i = 0; i < cpu.GetRegisters().size(); ++i)
+			os << (i > 0 ? ", " : "") << static_cast<unsigned>(cpu.GetRegisters()[i]);
+		os << "]\n";
+		os << "      }";
+		if (const auto* profile = chip8.GetProfile())
+		{
+			os << ",\n";
+			PrintProfileJson(os, *profile);
+		}
+		os << "\n    }";
+	}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	spdlog::set_level(spdlog::level::off);
+
+	bool success = true;
+	std::cout << "{\n  \"roms\": [\n";
+	for (std::size_t i = 0; i < options.roms.size(); ++i)
+	{
+		const auto& rom = options.roms[i];
+
+		emu::Chip8 chip8;
+		if (!chip8.LoadRom(rom))
+		{
+			std::cerr << "couldn't load " << rom << std::endl;
+			return 1;
+		}
+		chip8.GetRng().Seed(options.seed);
+		chip8.SetInstructionsPerSecond(options.instructionsPerSecond);
+		chip8.SetInstructionCacheEnabled(options.useInstructionCache);
+		chip8.SetSuperinstructionsEnabled(options.useSuperinstructions);
+		chip8.SetJitEnabled(options.useJit);
+		if (!options.tracePath.empty())
+		{
+			const auto tracePath = GetOutputPath(options.tracePath, i, options.roms.size());
+			if (!chip8.StartTrace(tracePath, options.traceCapacity))
+			{
+				std::cerr << "couldn't record a trace in " << tracePath << std::endl;
+				return 1;
+			}
+		}
+
+		chip8.SetSamplingProfilerEnabled(!options.foldedPath.empty(), options.samplePeriod);
+
+		const auto statistics = Run(chip8, options);
+		success &= chip8.IsValid();
+
+		if (!options.foldedPath.empty())
+		{
+			const auto foldedPath = GetOutputPath(options.foldedPath, i, options.roms.size());
+			std::ofstream folded(foldedPath);
+			chip8.GetSamplingProfiler()->WriteFolded(folded);
+			if (!folded)
+			{
+				std::cerr << "couldn't write " << foldedPath << std::endl;
+				return 1;
+			}
+		}
+
+		PrintJson(std::cout, rom, chip8, options, statistics);
+		std::cout << (i + 1 < options.roms.size() ? ",\n" : "\n");
+	}
+	std::cout << "  ]\n}" << std::endl;
+
+	return success ? 0 : 1;
+}
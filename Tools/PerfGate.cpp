@@ -0,0 +1,540 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * chip8-perf-gate: compares a chip8-benchmarks JSON output against a baseline, failing if any benchmark got slower
+ * than the tolerance allows, is missing from the results, or if the preset has no baseline at all.
+ *
+ * The baseline is a tab separated file, one "<preset>\t<benchmark>\t<throughput per second>" per line, as throughput
+ * depends on compiler and flags: only the lines of the given preset are compared. The throughput is the
+ * cycles_per_second counter if there's one (the ROM benchmarks), items_per_second or bytes_per_second otherwise.
+ * With repetitions, the median aggregate is used.
+ * */
+namespace
+{
+	struct Options
+	{
+		std::string baselinePath {};
+		std::string resultsPath {};
+		std::string preset {};
+		double tolerance = 0.1;
+		bool update = false;
+	};
+
+	// the fields of interest of a google benchmark JSON entry
+	struct BenchmarkEntry
+	{
+		std::map<std::string, std::string> fields {};
+
+		[[nodiscard]] std::string Get(const std::string& key) const
+		{
+			const auto it = fields.find(key);
+			return it != fields.end() ? it->second : std::string {};
+		}
+	};
+
+	/*
+	 * Just enough JSON to read google benchmark's output: every scalar in the objects of the top level "benchmarks"
+	 * array is collected as a string, anything else is skipped
+	 * */
+	class JsonReader
+	{
+	public:
+		explicit JsonReader(std::string text) : _text(std::move(text)) {}
+
+		bool ReadBenchmarks(std::vector<BenchmarkEntry>& entries)
+		{
+			SkipWhitespace();
+			if (!Consume('{'))
+				return false;
+
+			while (true)
+			{
+				SkipWhitespace();
+				if (Consume('}'))
+					return true;
+
+				std::string key;
+				if (!ReadString(key) || !ConsumeSeparator(':'))
+					return false;
+
+				if (key == "benchmarks")
+				{
+					if (!ReadEntries(entries))
+						return false;
+				}
+				else if (!SkipValue())
+					return false;
+
+				SkipWhitespace();
+				Consume(',');
+			}
+		}
+
+	private:
+		bool ReadEntries(std::vector<BenchmarkEntry>& entries)
+		{
+			SkipWhitespace();
+			if (!Consume('['))
+				return false;
+
+			while (true)
+			{
+				SkipWhitespace();
+				if (Consume(']'))
+					return true;
+
+				BenchmarkEntry entry;
+				if (!ReadEntry(entry))
+					return false;
+				entries.push_back(std::move(entry));
+
+				SkipWhitespace();
+				Consume(',');
+			}
+		}
+
+		bool ReadEntry(BenchmarkEntry& entry)
+		{
+			if (!Consume('{'))
+				return false;
+
+			while (true)
+			{
+				SkipWhitespace();
+				if (Consume('}'))
+					return true;
+
+				std::string key;
+				if (!ReadString(key) || !ConsumeSeparator(':'))
+					return false;
+
+				SkipWhitespace();
+				if (Peek() == '"')
+				{
+					if (!ReadString(entry.fields[key]))
+						return false;
+				}
+				else if (Peek() == '{' || Peek() == '[')
+				{
+					if (!SkipValue())
+						return false;
+				}
+				else
+					entry.fields[key] = ReadLiteral();
+
+				SkipWhitespace();
+				Consume(',');
+			}
+		}
+
+		bool ReadString(std::string& str)
+		{
+			SkipWhitespace();
+			if (!Consume('"'))
+				return false;
+
+			while (_position < _text.size() && _text[_position] != '"')
+			{
+				if (_text[_position] == '\\' && _position + 1 < _text.size())
+					++_position;
+				str += _text[_position++];
+			}
+			return Consume('"');
+		}
+
+		// numbers, true, false and null
+		std::string ReadLiteral()
+		{
+			const auto begin = _position;
+			while (_position < _text.size() && _text[_position] != ',' && _text[_position] != '}' &&
+				   _text[_position] != ']' && !std::isspace(static_cast<unsigned char>(_text[_position])))
+				++_position;
+			return _text.substr(begin, _position - begin);
+		}
+
+		bool SkipValue()
+		{
+			SkipWhitespace();
+			if (Peek() == '"')
+			{
+				std::string ignored;
+				return ReadString(ignored);
+			}
+			if (Peek() != '{' && Peek() != '[')
+				return !ReadLiteral().empty();
+
+			// strings can hold brackets
+			std::size_t depth = 0;
+			do
+			{
+				if (Peek() == '"')
+				{
+					std::string ignored;
+					if (!ReadString(ignored))
+						return false;
+					continue;
+				}
+				if (Peek() == '{' || Peek() == '[')
+					++depth;
+				else if (Peek() == '}' || Peek() == ']')
+					--depth;
+				++_position;
+			} while (depth > 0 && _position < _text.size());
+
+			return depth == 0;
+		}
+
+		void SkipWhitespace()
+		{
+			while (_position < _text.size() && std::isspace(static_cast<unsigned char>(_text[_position])))
+				++_position;
+		}
+		bool ConsumeSeparator(const char c)
+		{
+			SkipWhitespace();
+			return Consume(c);
+		}
+		bool Consume(const char c)
+		{
+			if (Peek() != c)
+				return false;
+			++_position;
+			return true;
+		}
+		[[nodiscard]] char Peek() const { return _position < _text.size() ? _text[_position] : '\0'; }
+
+		std::string _text;
+		std::size_t _position = 0;
+	};
+
+	struct Result
+	{
+		std::optional<double> throughput {};
+		bool error = false;
+	};
+
+	// nullopt unless the whole of text is a number
+	std::optional<double> ParseNumber(const std::string& text)
+	{
+		std::istringstream is(text);
+		double value = 0.0;
+		if (!(is >> value) || !(is >> std::ws).eof())
+			return std::nullopt;
+		return value;
+	}
+
+	// false if the throughput is there, but isn't a number: throughput is left empty if there's none
+	bool ParseThroughput(const BenchmarkEntry& entry, std::optional<double>& throughput)
+	{
+		for (const auto* key : { "cycles_per_second", "items_per_second", "bytes_per_second" })
+		{
+			const auto value = entry.Get(key);
+			if (!value.empty())
+			{
+				throughput = ParseNumber(value);
+				return throughput.has_value();
+			}
+		}
+		return true;
+	}
+
+	double Median(std::vector<double> values)
+	{
+		std::sort(values.begin(), values.end());
+		const auto middle = values.size() / 2;
+		return values.size() % 2 == 1 ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+	}
+
+	// one throughput per benchmark: the median aggregate, or the median of the repetitions
+	bool ReadResults(const std::string& path, std::map<std::string, Result>& results)
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
+		{
+			std::cerr << "couldn't open " << path << std::endl;
+			return false;
+		}
+		std::stringstream ss;
+		ss << file.rdbuf();
+
+		std::vector<BenchmarkEntry> entries;
+		if (!JsonReader(ss.str()).ReadBenchmarks(entries))
+		{
+			std::cerr << path << ": not a google benchmark JSON output" << std::endl;
+			return false;
+		}
+
+		std::map<std::string, std::vector<double>> repetitions;
+		std::map<std::string, double> medians;
+		for (const auto& entry : entries)
+		{
+			auto name = entry.Get("run_name");
+			if (name.empty())
+				name = entry.Get("name");
+
+			auto& result = results[name];
+			if (entry.Get("error_occurred") == "true")
+			{
+				result.error = true;
+				continue;
+			}
+
+			std::optional<double> throughput;
+			if (!ParseThroughput(entry, throughput))
+			{
+				std::cerr << path << ": malformed throughput of " << name << std::endl;
+				return false;
+			}
+			if (!throughput)
+				continue;
+			if (entry.Get("run_type") != "aggregate")
+				repetitions[name].push_back(*throughput);
+			else if (entry.Get("aggregate_name") == "median")
+				medians[name] = *throughput;
+		}
+
+		for (auto& [name, result] : results)
+		{
+			if (medians.count(name) > 0)
+				result.throughput = medians[name];
+			else if (!repetitions[name].empty())
+				result.throughput = Median(repetitions[name]);
+		}
+
+		return true;
+	}
+
+	using Baseline = std::map<std::string, std::map<std::string, double>>;
+
+	bool ReadBaseline(const std::string& path, Baseline& baseline)
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
+		{
+			std::cerr << "couldn't open " << path << std::endl;
+			return false;
+		}
+
+		std::string line;
+		for (std::size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+		{
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::istringstream is(line);
+			std::string preset;
+			std::string name;
+			std::string throughput;
+			std::optional<double> value;
+			if (std::getline(is, preset, '\t') && std::getline(is, name, '\t') && std::getline(is, throughput))
+				value = ParseNumber(throughput);
+			if (!value)
+			{
+				std::cerr << path << ":" << lineNumber << ": expected \"<preset>\\t<benchmark>\\t<throughput>\""
+						  << std::endl;
+				return false;
+			}
+			baseline[preset][name] = *value;
+		}
+
+		return true;
+	}
+
+	bool WriteBaseline(const std::string& path, const Baseline& baseline)
+	{
+		std::ofstream file(path);
+		if (!file.is_open())
+		{
+			std::cerr << "couldn't write " << path << std::endl;
+			return false;
+		}
+
+		file << "# chip8-perf-gate baseline: <preset>\\t<benchmark>\\t<throughput per second>\n";
+		file << "# regenerate with: cmake --build <build folder> --target update-perf-baseline\n";
+		for (const auto& [preset, benchmarks] : baseline)
+		{
+			for (const auto& [name, throughput] : benchmarks)
+				file << preset << '\t' << name << '\t' << static_cast<std::uint64_t>(std::llround(throughput)) << '\n';
+		}
+
+		return true;
+	}
+
+	std::string FormatThroughput(const std::optional<double> throughput)
+	{
+		if (!throughput)
+			return "-";
+
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.2fM/s", *throughput * 1e-6);
+		return buffer;
+	}
+
+	// prints one row per benchmark, and returns how many regressed or went missing
+	std::size_t Compare(std::ostream& os, const std::map<std::string, double>& baseline,
+						const std::map<std::string, Result>& results, const double tolerance)
+	{
+		std::size_t nameWidth = std::string("benchmark").size();
+		for (const auto& [name, result] : results)
+			nameWidth = std::max(nameWidth, name.size());
+		for (const auto& [name, throughput] : baseline)
+			nameWidth = std::max(nameWidth, name.size());
+
+		char buffer[256];
+		const auto printRow = [&](const std::string& name, const std::string& before, const std::string& after,
+								  const std::string& change, const std::string& status)
+		{
+			std::snprintf(buffer, sizeof(buffer), "%-*s  %14s  %14s  %8s  %s", static_cast<int>(nameWidth),
+						  name.c_str(), before.c_str(), after.c_str(), change.c_str(), status.c_str());
+			os << buffer << '\n';
+		};
+		printRow("benchmark", "baseline", "current", "change", "status");
+
+		std::size_t nRegressions = 0;
+		for (const auto& [name, result] : results)
+		{
+			const auto it = baseline.find(name);
+			const auto before = it != baseline.end() ? std::optional<double>(it->second) : std::nullopt;
+
+			std::string change = "-";
+			std::string status = "new";
+			if (result.error || !result.throughput)
+			{
+				status = result.error ? "error" : "no throughput";
+				if (before)
+				{
+					status = "REGRESSED (" + status + ")";
+					++nRegressions;
+				}
+			}
+			else if (before)
+			{
+				const auto relativeChange = *result.throughput / *before - 1.0;
+				std::snprintf(buffer, sizeof(buffer), "%+.1f%%", 100.0 * relativeChange);
+				change = buffer;
+
+				status = "ok";
+				if (relativeChange < -tolerance)
+				{
+					status = "REGRESSED";
+					++nRegressions;
+				}
+			}
+			printRow(name, FormatThroughput(before), FormatThroughput(result.throughput), change, status);
+		}
+
+		// a benchmark that disappeared might have been renamed, which would hide its regressions: rename it in the
+		// baseline too, or drop it with --update
+		for (const auto& [name, throughput] : baseline)
+		{
+			if (results.count(name) == 0)
+			{
+				printRow(name, FormatThroughput(throughput), "-", "-", "MISSING");
+				++nRegressions;
+			}
+		}
+
+		return nRegressions;
+	}
+
+	void PrintUsage()
+	{
+		std::cerr << "usage: chip8-perf-gate --baseline FILE --results FILE --preset NAME [options]\n"
+					 "  --baseline FILE  tab separated \"<preset> <benchmark> <throughput>\" lines\n"
+					 "  --results FILE   chip8-benchmarks --benchmark_out_format=json output\n"
+					 "  --preset NAME    the baseline lines to compare against, e.g. gcc-release\n"
+					 "  --tolerance X    largest accepted slow down, as a fraction (default 0.1)\n"
+					 "  --update         replace the preset's baseline with the results, instead of comparing\n";
+	}
+
+	bool ParseOptions(const int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			const auto hasValue = i + 1 < argc;
+			if (arg == "--baseline" && hasValue)
+				options.baselinePath = argv[++i];
+			else if (arg == "--results" && hasValue)
+				options.resultsPath = argv[++i];
+			else if (arg == "--preset" && hasValue)
+				options.preset = argv[++i];
+			else if (arg == "--tolerance" && hasValue)
+			{
+				const auto tolerance = ParseNumber(argv[++i]);
+				if (!tolerance || *tolerance < 0.0)
+					return false;
+				options.tolerance = *tolerance;
+			}
+			else if (arg == "--update")
+				options.update = true;
+			else
+				return false;
+		}
+
+		return !options.baselinePath.empty() && !options.resultsPath.empty() && !options.preset.empty();
+	}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::map<std::string, Result> results;
+	if (!ReadResults(options.resultsPath, results))
+		return 1;
+
+	Baseline baseline;
+	if (!ReadBaseline(options.baselinePath, baseline) && !options.update)
+		return 1;
+
+	if (options.update)
+	{
+		auto& presetBaseline = baseline[options.preset];
+		presetBaseline.clear();
+		for (const auto& [name, result] : results)
+		{
+			if (!result.error && result.throughput)
+				presetBaseline[name] = *result.throughput;
+		}
+
+		if (!WriteBaseline(options.baselinePath, baseline))
+			return 1;
+		std::cout << "updated " << presetBaseline.size() << " " << options.preset << " benchmarks in "
+				  << options.baselinePath << std::endl;
+		return 0;
+	}
+
+	const auto it = baseline.find(options.preset);
+	if (it == baseline.end())
+	{
+		// passing would let the gate silently check nothing
+		std::cerr << "no baseline for preset " << options.preset << " in " << options.baselinePath
+				  << ": record one with --update" << std::endl;
+		return 1;
+	}
+
+	const auto nRegressions = Compare(std::cout, it->second, results, options.tolerance);
+	std::cout << "\n"
+			  << nRegressions << " benchmarks regressed by more than " << 100.0 * options.tolerance
+			  << "% or are missing (" << options.preset << ")" << std::endl;
+
+	return nRegressions == 0 ? 0 : 1;
+}
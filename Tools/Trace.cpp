@@ -0,0 +1,145 @@
+#include "Emulator/DecodeTable.h"
+#include "Emulator/Trace.h"
+
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * chip8-trace: prints the instructions recorded in a binary trace, see Emulator/Trace.h, one per line:
+ *  <cycle> <pc> <instruction> <instruction set id> <cpu method> I=<I> [V<x>=<value written>]
+ * Traces are recorded by chip8-headless --trace, or by Chip8::StartTrace.
+ * */
+namespace
+{
+	struct Options
+	{
+		std::string trace {};
+		// [pcBegin, pcEnd)
+		std::size_t pcBegin = 0;
+		std::size_t pcEnd = 0x10000;
+		std::optional<emu::Instruction::Enum> instruction {};
+		std::optional<std::size_t> tail {};
+	};
+
+	void PrintUsage()
+	{
+		std::cerr << "usage: chip8-trace [options] <trace>\n"
+					 "  --pc BEGIN:END   only the instructions fetched in [BEGIN, END), hex (e.g. 200:300)\n"
+					 "  --opcode ID      only the given instruction, either its id (e.g. 0xDxyn) or its cpu method\n"
+					 "                   (e.g. Draw)\n"
+					 "  --tail N         only the last N instructions matching the filters\n";
+	}
+
+	std::optional<emu::Instruction::Enum> ParseInstruction(const std::string& name)
+	{
+		for (auto code = emu::Instruction::START; code < emu::Instruction::END;
+			 code = static_cast<emu::Instruction::Enum>(code + 1))
+		{
+			if (name == emu::instructionSetIds[code] || name == emu::cpuInstructionMapping[code])
+				return code;
+		}
+		return std::nullopt;
+	}
+
+	// throws std::invalid_argument or std::out_of_range on malformed numbers, e.g. "--tail abc"
+	bool ParseOptionsOrThrow(const int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			const auto hasValue = i + 1 < argc;
+			if (arg == "--pc" && hasValue)
+			{
+				const std::string range = argv[++i];
+				const auto separator = range.find(':');
+				if (separator == std::string::npos)
+					return false;
+				options.pcBegin = std::stoull(range.substr(0, separator), nullptr, 16);
+				options.pcEnd = std::stoull(range.substr(separator + 1), nullptr, 16);
+			}
+			else if (arg == "--opcode" && hasValue)
+			{
+				options.instruction = ParseInstruction(argv[++i]);
+				if (!options.instruction)
+				{
+					std::cerr << "unknown instruction " << argv[i] << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--tail" && hasValue)
+				options.tail = std::stoull(argv[++i]);
+			else if (arg.rfind("--", 0) == 0 || !options.trace.empty())
+				return false;
+			else
+				options.trace = arg;
+		}
+
+		return !options.trace.empty();
+	}
+
+	// false on unknown options and malformed values
+	bool ParseOptions(const int argc, char** argv, Options& options)
+	{
+		try
+		{
+			return ParseOptionsOrThrow(argc, argv, options);
+		}
+		catch (const std::logic_error&)
+		{
+			// the usage is printed instead
+			return false;
+		}
+	}
+
+	bool Matches(const emu::TraceRecord& record, const Options& options)
+	{
+		if (record.programCounter < options.pcBegin || record.programCounter >= options.pcEnd)
+			return false;
+		return !options.instruction || emu::decodeTable[record.instruction].code == *options.instruction;
+	}
+
+	void Print(const emu::TraceRecord& record)
+	{
+		const auto code = emu::decodeTable[record.instruction].code;
+		std::printf("%10llu  %03X  %04X  %-6s  %-37s  I=%03X", static_cast<unsigned long long>(record.cycle),
+					record.programCounter, record.instruction, emu::instructionSetIds[code].data(),
+					emu::cpuInstructionMapping[code].data(), record.indexRegister);
+		if (record.registerIndex != emu::TraceRecord::noRegister)
+			std::printf("  V%X=%02X", record.registerIndex, record.registerValue);
+		std::printf("\n");
+	}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<emu::TraceRecord> records;
+	if (!emu::ReadTrace(options.trace, records))
+	{
+		std::cerr << "couldn't read " << options.trace << std::endl;
+		return 1;
+	}
+
+	std::vector<const emu::TraceRecord*> matches;
+	for (const auto& record : records)
+	{
+		if (Matches(record, options))
+			matches.push_back(&record);
+	}
+
+	const auto first = options.tail && *options.tail < matches.size() ? matches.size() - *options.tail : 0;
+	for (auto i = first; i < matches.size(); ++i)
+		Print(*matches[i]);
+
+	return 0;
+}
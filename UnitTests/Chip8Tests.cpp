@@ -4,6 +4,9 @@
 
 #include <gtest/gtest.h>
 
+#include <random>
+#include <sstream>
+
 struct TestKeyPad final: public emu::IKeypad, public emu::ISerializable
 {
 	std::bitset<emu::Keys::END> toggle {};
@@ -120,6 +123,12 @@ struct TestChip8: public emu::detail::Chip8<TestCpu, TestRng, TestRam, TestDispl
 class Chip8Tests: public ::testing::Test
 {
 public:
+#ifdef CHIP8_PROFILER
+	static constexpr bool isProfilerEnabled = true;
+#else
+	static constexpr bool isProfilerEnabled = false;
+#endif
+
 	bool ExecuteInstruction(TestChip8& chip8, const emu::TwoBytes instruction)
 	{
 		chip8._cpu._programCounter = 0;
@@ -676,6 +685,55 @@ static void CheckAreEqual(const EmuT& lhs, const EmuT& rhs)
 	}
 }
 
+// a Chip8 with real devices, exposed to CheckAreEqual
+struct RomChip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+{
+	using Base = emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>;
+	using Base::_cpu;
+	using Base::_display;
+	using Base::_keypad;
+	using Base::_ram;
+};
+
+static std::size_t RunThroughKeyWaits(RomChip8& chip8, const std::size_t nCycles)
+{
+	return chip8.RunCyclesThroughKeyWaits(nCycles).cycles;
+}
+
+/*
+ * Runs the test ROMs on a chip8 set up by configure, batch by batch through run(chip8, nCycles) (returning the
+ * instructions executed), and on the interpreter one Cycle() at a time: the last executed instruction must be the same
+ * after each batch, and the whole state at the end.
+ * */
+template<typename Configure, typename Run>
+static void CheckSameResultsAsInterpreter(Configure&& configure, Run&& run, const std::vector<std::size_t>& batches)
+{
+	auto* dataPath = std::getenv("DATA_PATH");
+	ASSERT_NE(dataPath, nullptr);
+	for (const auto* rom : { "/test_opcode.ch8", "/test-rom.ch8", "/c8_test.c8", "/ibm_logo.ch8", "/BC_test.ch8" })
+	{
+		SCOPED_TRACE(rom);
+
+		RomChip8 chip8;
+		configure(chip8);
+		ASSERT_TRUE(chip8.LoadRom(std::string(dataPath) + rom));
+
+		RomChip8 interpreter;
+		ASSERT_TRUE(interpreter.LoadRom(std::string(dataPath) + rom));
+
+		for (const auto nCycles : batches)
+		{
+			ASSERT_EQ(run(chip8, nCycles), nCycles) << chip8.GetLastError();
+			for (size_t i = 0; i < nCycles; ++i)
+				ASSERT_TRUE(interpreter.Cycle()) << interpreter.GetLastError();
+			ASSERT_EQ(chip8.GetLastExecutedInstruction(), interpreter.GetLastExecutedInstruction());
+			ASSERT_EQ(chip8.GetLastExecutedInstructionCode(), interpreter.GetLastExecutedInstructionCode());
+		}
+
+		CheckAreEqual(chip8, interpreter);
+	}
+}
+
 TEST_F(Chip8Tests, Serialize)
 {
 	spdlog::set_level(spdlog::level::off);
@@ -763,6 +821,754 @@ TEST_F(Chip8Tests, SerializeToFile)
 	CheckAreEqual(deserializedChip8, chip8);
 }
 
+TEST_F(Chip8Tests, InstructionCacheGivesSameResults)
+{
+	spdlog::set_level(spdlog::level::off);
+
+	CheckSameResultsAsInterpreter(
+		[](RomChip8& chip8)
+		{
+			ASSERT_TRUE(chip8.IsInstructionCacheEnabled());
+			chip8.SetInstructionCacheEnabled(false);
+			ASSERT_FALSE(chip8.IsInstructionCacheEnabled());
+		},
+		[](RomChip8& chip8, const std::size_t) -> std::size_t { return chip8.Cycle() ? 1 : 0; },
+		std::vector<std::size_t>(500, 1));
+}
+
+TEST_F(Chip8Tests, InstructionCacheIsInvalidatedBySelfModifyingCode)
+{
+	spdlog::set_level(spdlog::level::off);
+
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_cpu;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+	Chip8 chip8;
+
+	// 0x200: V1 = 0x00 -> overwritten by Fx55 with V1 = 0x42
+	const std::string program = {
+		'\x61', '\x00',	 // 0x200: V1 = 0x00
+		'\x60', '\x61',	 // 0x202: V0 = 0x61
+		'\x61', '\x42',	 // 0x204: V1 = 0x42
+		'\xA2', '\x00',	 // 0x206: I = 0x200
+		'\xF1', '\x55',	 // 0x208: ram[I, I + 1] = V0, V1
+		'\x61', '\x00',	 // 0x20A: V1 = 0x00
+		'\x12', '\x00',	 // 0x20C: jump to 0x200
+	};
+	chip8._ram.Load(program);
+
+	// first pass: everything gets cached
+	for (size_t i = 0; i < 7; ++i)
+		ASSERT_TRUE(chip8.Cycle()) << chip8.GetLastError();
+	ASSERT_EQ(chip8._cpu._registers[0x1], 0x00);
+	ASSERT_EQ(chip8._cpu._programCounter, 0x200);
+
+	// second pass: 0x200 must be decoded again
+	ASSERT_TRUE(chip8.Cycle()) << chip8.GetLastError();
+	ASSERT_EQ(chip8.GetLastExecutedInstruction(), 0x6142);
+	ASSERT_EQ(chip8._cpu._registers[0x1], 0x42);
+
+	const std::string bcdProgram = {
+		'\x63', '\x05',	 // 0x200: V3 = 0x05
+		'\x62', '\x0A',	 // 0x202: V2 = 10
+		'\xA2', '\x00',	 // 0x204: I = 0x200
+		'\xF2', '\x33',	 // 0x206: ram[I, I + 1, I + 2] = bcd(V2) = 0, 1, 0
+		'\x12', '\x00',	 // 0x208: jump to 0x200
+	};
+	Chip8 bcdChip8;
+	bcdChip8._ram.Load(bcdProgram);
+	for (size_t i = 0; i < 5; ++i)
+		ASSERT_TRUE(bcdChip8.Cycle()) << bcdChip8.GetLastError();
+	ASSERT_EQ(bcdChip8._cpu._registers[0x3], 0x05);
+
+	// 0x200 is now 0x0001, which is illegal
+	ASSERT_FALSE(bcdChip8.Cycle());
+	ASSERT_EQ(bcdChip8.GetLastError(), emu::Error::InvalidInstruction);
+}
+
+TEST_F(Chip8Tests, RunCyclesGivesSameResultsAsCycle)
+{
+	spdlog::set_level(spdlog::level::off);
+
+	RomChip8 chip8;
+	ASSERT_EQ(chip8.RunCycles(0).cycles, 0);
+
+	CheckSameResultsAsInterpreter([](RomChip8&) {}, RunThroughKeyWaits, { 1, 2, 7, 100, 390 });
+}
+
+TEST_F(Chip8Tests, RunCyclesStopsAtFirstError)
+{
+	spdlog::set_level(spdlog::level::off);
+
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_cpu;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+	Chip8 chip8;
+
+	const std::string program = {
+		'\x61', '\x01',	 // 0x200: V1 = 0x01
+		'\x71', '\x01',	 // 0x202: V1 += 0x01
+		'\xF0', '\xFF',	 // 0x204: illegal
+	};
+	chip8._ram.Load(program);
+
+	const auto result = chip8.RunCycles(100);
+	ASSERT_EQ(result.cycles, 2);
+	ASSERT_EQ(result.stopReason, emu::StopReason::Error);
+	ASSERT_EQ(chip8.GetLastError(), emu::Error::InvalidInstruction);
+	ASSERT_EQ(chip8.GetLastExecutedInstructionCode(), emu::Instruction::END);
+	ASSERT_EQ(chip8._cpu._registers[0x1], 0x02);
+	ASSERT_EQ(chip8._cpu._programCounter, 0x206);
+
+	// no further progress once in an error state
+	ASSERT_EQ(chip8.RunCycles(100).cycles, 0);
+	ASSERT_FALSE(chip8.Cycle());
+}
+
+TEST_F(Chip8Tests, BatchedRunsStopEarly)
+{
+	spdlog::set_level(spdlog::level::off);
+
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_cpu;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+
+	for (const auto useSuperinstructions : { false, true })
+	{
+		Chip8 chip8;
+		chip8.SetSuperinstructionsEnabled(useSuperinstructions);
+
+		const std::string program = {
+			'\x00', '\xE0',	 // 0x200: clear
+			'\x60', '\x05',	 // 0x202: V0 = 0x05
+			'\x70', '\x01',	 // 0x204: V0 += 0x01
+			'\x12', '\x04',	 // 0x206: jump to 0x204
+		};
+		chip8._ram.Load(program);
+
+		auto result = chip8.RunCycles(10, true);
+		ASSERT_EQ(result.cycles, 1);
+		ASSERT_EQ(result.stopReason, emu::StopReason::DisplayChanged);
+		ASSERT_TRUE(result.displayChanged);
+
+		result = chip8.RunCycles(10);
+		ASSERT_EQ(result.cycles, 10);
+		ASSERT_EQ(result.stopReason, emu::StopReason::None);
+		ASSERT_FALSE(result.displayChanged);
+		ASSERT_EQ(chip8._cpu._programCounter, 0x206);
+
+		// the instruction at pc runs anyway, so that a run can resume from a breakpoint
+		chip8.SetBreakpoint(0x206, true);
+		ASSERT_TRUE(chip8.HasBreakpoint(0x206));
+		result = chip8.RunCycles(10);
+		ASSERT_EQ(result.cycles, 2);
+		ASSERT_EQ(result.stopReason, emu::StopReason::Breakpoint);
+		ASSERT_EQ(chip8._cpu._programCounter, 0x206);
+		chip8.ClearBreakpoints();
+		ASSERT_FALSE(chip8.HasBreakpoint(0x206));
+
+		result = chip8.RunUntil([](const auto& c) { return c.GetCpu().GetRegisters()[0x0] == 0x20; }, 1000);
+		ASSERT_EQ(result.stopReason, emu::StopReason::Predicate);
+		ASSERT_EQ(chip8._cpu._registers[0x0], 0x20);
+		ASSERT_EQ(chip8._cpu._programCounter, 0x206);
+
+		result = chip8.RunUntil([](const auto&) { return false; }, 3);
+		ASSERT_EQ(result.cycles, 3);
+		ASSERT_EQ(result.stopReason, emu::StopReason::None);
+
+		ASSERT_EQ(chip8.RunFrame().cycles, chip8.GetCyclesPerFrame());
+		chip8.SetInstructionsPerSecond(25 * Chip8::timerFrequency);
+		ASSERT_EQ(chip8.RunFrame().cycles, 25);
+
+		// 7xkk + 3xkk is a superinstruction: RunUntil still goes one instruction at a time
+		Chip8 fused;
+		fused.SetSuperinstructionsEnabled(useSuperinstructions);
+		const std::string fusedProgram = {
+			'\x70', '\x01',	 // 0x200: V0 += 0x01
+			'\x30', '\x40',	 // 0x202: skip if V0 == 0x40
+			'\x12', '\x00',	 // 0x204: jump to 0x200
+		};
+		fused._ram.Load(fusedProgram);
+
+		result = fused.RunUntil([](const auto&) { return false; }, 30);
+		ASSERT_EQ(result.cycles, 30);
+		ASSERT_EQ(result.stopReason, emu::StopReason::None);
+		ASSERT_EQ(fused._cpu._registers[0x0], 10);
+		ASSERT_EQ(fused._cpu._programCounter, 0x200);
+
+		result = fused.RunUntil([](const auto& c) { return c.GetCpu().GetProgramCounter() == 0x202; }, 30);
+		ASSERT_EQ(result.cycles, 1);
+		ASSERT_EQ(result.stopReason, emu::StopReason::Predicate);
+		ASSERT_EQ(fused._cpu._programCounter, 0x202);
+
+		fused.SetBreakpoint(0x202, true);
+		result = fused.RunUntil([](const auto&) { return false; }, 30);
+		ASSERT_EQ(result.cycles, 3);
+		ASSERT_EQ(result.stopReason, emu::StopReason::Breakpoint);
+		ASSERT_EQ(fused._cpu._registers[0x0], 12);
+	}
+
+	Chip8 chip8;
+	const std::string program = {
+		'\xF1', '\x0A',	 // 0x200: V1 = next key pressed
+		'\x12', '\x02',	 // 0x202: jump to 0x202
+	};
+	chip8._ram.Load(program);
+
+	auto result = chip8.RunCycles(10);
+	ASSERT_EQ(result.cycles, 1);
+	ASSERT_EQ(result.stopReason, emu::StopReason::WaitingForKey);
+	ASSERT_EQ(chip8._cpu._programCounter, 0x200);
+
+	chip8.GetKeypad().Press(emu::Keys::Five, true);
+	result = chip8.RunCycles(10);
+	ASSERT_EQ(result.cycles, 10);
+	ASSERT_EQ(result.stopReason, emu::StopReason::None);
+	ASSERT_EQ(chip8._cpu._registers[0x1], 0x5);
+}
+
+TEST_F(Chip8Tests, JitGivesSameResults)
+{
+	if (!emu::Jit::IsSupported())
+		GTEST_SKIP() << "jit not supported";
+	if (isProfilerEnabled)
+		GTEST_SKIP() << "jit blocks are skipped while profiling";
+	spdlog::set_level(spdlog::level::off);
+
+	CheckSameResultsAsInterpreter(
+		[](RomChip8& chip8)
+		{
+			chip8.SetJitEnabled(true);
+			ASSERT_TRUE(chip8.IsJitEnabled());
+		},
+		RunThroughKeyWaits, { 2000 });
+
+	// every compilable instruction, with random operands (VF included), in two blocks split by a skip
+	for (unsigned seed = 0; seed < 20; ++seed)
+	{
+		std::mt19937 generator(seed);
+		const auto randomByte = [&]() { return static_cast<char>(generator() & 0xFF); };
+		const auto randomNibble = [&]() { return static_cast<char>(generator() & 0xF); };
+
+		std::string program;
+		for (size_t block = 0; block < 2; ++block)
+		{
+			for (size_t i = 0; i < 40; ++i)
+			{
+				switch (generator() % 6)
+				{
+					case 0:
+						program += { static_cast<char>(0x60 | randomNibble()), randomByte() };
+						break;
+					case 1:
+						program += { static_cast<char>(0x70 | randomNibble()), randomByte() };
+						break;
+					case 2:
+					{
+						static constexpr std::array<char, 9> aluCodes = { 0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE };
+						const auto aluCode = aluCodes[generator() % aluCodes.size()];
+						program += { static_cast<char>(0x80 | randomNibble()),
+									 static_cast<char>((randomNibble() << 4) | aluCode) };
+						break;
+					}
+					case 3:
+						program += { static_cast<char>(0xA0 | randomNibble()), randomByte() };
+						break;
+					case 4:
+						program += { static_cast<char>(0xF0 | randomNibble()), '\x1E' };
+						break;
+					default:
+						program += { static_cast<char>(0x80 | randomNibble()),
+									 static_cast<char>((randomNibble() << 4) | 0x4) };
+						break;
+				}
+			}
+			if (block == 0)
+				program += { static_cast<char>(0x30 | randomNibble()), randomByte() };
+		}
+		program += { '\x12', '\x00' };
+
+		RomChip8 jit;
+		jit.SetJitEnabled(true);
+		jit._ram.Load(program);
+		jit._cpu._delayTimer = 200;
+
+		RomChip8 interpreter;
+		interpreter._ram.Load(program);
+		interpreter._cpu._delayTimer = 200;
+
+		ASSERT_EQ(jit.RunCycles(5000).cycles, 5000) << jit.GetLastError();
+		for (size_t i = 0; i < 5000; ++i)
+			ASSERT_TRUE(interpreter.Cycle()) << interpreter.GetLastError();
+		ASSERT_GT(jit.GetJit()->GetCompiledBlocks(), 0);
+		ASSERT_EQ(jit.GetLastExecutedInstruction(), interpreter.GetLastExecutedInstruction());
+		ASSERT_EQ(jit.GetLastExecutedInstructionCode(), interpreter.GetLastExecutedInstructionCode());
+
+		CheckAreEqual(jit, interpreter);
+	}
+}
+
+TEST_F(Chip8Tests, JitBlocksAreInvalidatedBySelfModifyingCode)
+{
+	if (!emu::Jit::IsSupported())
+		GTEST_SKIP() << "jit not supported";
+	if (isProfilerEnabled)
+		GTEST_SKIP() << "jit blocks are skipped while profiling";
+	spdlog::set_level(spdlog::level::off);
+
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_cpu;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+	Chip8 chip8;
+	chip8.SetJitEnabled(true);
+
+	// 0x202: V1 += 1, until V2 reaches 0x20: then V1 += 1 is patched into V1 += 0x10
+	const std::string program = {
+		'\x61', '\x00',	 // 0x200: V1 = 0x00
+		'\x71', '\x01',	 // 0x202: V1 += 0x01
+		'\x72', '\x01',	 // 0x204: V2 += 0x01
+		'\x32', '\x20',	 // 0x206: skip if V2 == 0x20
+		'\x12', '\x02',	 // 0x208: jump to 0x202
+		'\x60', '\x71',	 // 0x20A: V0 = 0x71
+		'\x61', '\x10',	 // 0x20C: V1 = 0x10
+		'\xA2', '\x02',	 // 0x20E: I = 0x202
+		'\xF1', '\x55',	 // 0x210: ram[I, I + 1] = V0, V1
+		'\x61', '\x00',	 // 0x212: V1 = 0x00
+		'\x12', '\x02',	 // 0x214: jump to 0x202
+	};
+	chip8._ram.Load(program);
+
+	// 0x1F full loops, plus the first 3 instructions of the last one: by now 0x202 has been compiled
+	ASSERT_EQ(chip8.RunCycles(1 + 0x1F * 4 + 3).cycles, 1 + 0x1F * 4 + 3) << chip8.GetLastError();
+	ASSERT_EQ(chip8._cpu._registers[0x1], 0x20);
+	ASSERT_EQ(chip8._cpu._registers[0x2], 0x20);
+	ASSERT_EQ(chip8._cpu._programCounter, 0x20A);
+	ASSERT_GT(chip8.GetJit()->GetCompiledBlocks(), 0);
+
+	// patch, and one more time through the (recompiled) loop body
+	ASSERT_EQ(chip8.RunCycles(8).cycles, 8) << chip8.GetLastError();
+	ASSERT_EQ(chip8.GetRam().GetAt(0x203), 0x10);
+	ASSERT_EQ(chip8._cpu._registers[0x1], 0x10);
+	ASSERT_EQ(chip8._cpu._registers[0x2], 0x21);
+
+	// the blocks are dropped along with the instruction cache, e.g. when a ROM is loaded
+	chip8.SetInstructionCacheEnabled(true);
+	ASSERT_EQ(chip8.GetJit()->GetCompiledBlocks(), 0);
+}
+
+TEST_F(Chip8Tests, SuperinstructionsGiveSameResults)
+{
+	spdlog::set_level(spdlog::level::off);
+
+	for (const auto useInstructionCache : { true, false })
+	{
+		CheckSameResultsAsInterpreter(
+			[=](RomChip8& chip8)
+			{
+				chip8.SetInstructionCacheEnabled(useInstructionCache);
+				chip8.SetSuperinstructionsEnabled(true);
+				ASSERT_TRUE(chip8.AreSuperinstructionsEnabled());
+			},
+			RunThroughKeyWaits, { 2000 });
+	}
+}
+
+TEST_F(Chip8Tests, SuperinstructionStatistics)
+{
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_cpu;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+
+	const std::string program = {
+		'\x60', '\x03',	 // 0x200: V0 = 0x03
+		'\xF0', '\x15',	 // 0x202: delay timer = V0
+		'\xF1', '\x07',	 // 0x204: V1 = delay timer
+		'\x31', '\x00',	 // 0x206: skip if V1 == 0x00
+		'\x12', '\x04',	 // 0x208: jump to 0x204
+		'\x72', '\x01',	 // 0x20A: V2 += 0x01
+		'\x32', '\x04',	 // 0x20C: skip if V2 == 0x04
+		'\x12', '\x0A',	 // 0x20E: jump to 0x20A
+		'\xA0', '\x00',	 // 0x210: I = 0x000
+		'\xD0', '\x05',	 // 0x212: draw 5 rows at (V0, V0)
+		'\x12', '\x14',	 // 0x214: jump to 0x214
+	};
+
+	for (const auto useInstructionCache : { true, false })
+	{
+		Chip8 chip8;
+		chip8.SetInstructionCacheEnabled(useInstructionCache);
+		chip8.SetSuperinstructionsEnabled(true);
+		// one timer tick per instruction
+		chip8.SetInstructionsPerSecond(Chip8::timerFrequency);
+		chip8._ram.Load(program);
+
+		ASSERT_EQ(chip8.RunCycles(100).cycles, 100) << chip8.GetLastError();
+		ASSERT_EQ(chip8._cpu._programCounter, 0x214);
+		ASSERT_EQ(chip8._cpu._registers[0x1], 0x00);
+		ASSERT_EQ(chip8._cpu._registers[0x2], 0x04);
+
+		// the last poll doesn't jump back
+		const auto& statistics = chip8.GetSuperinstructionStatistics();
+		const auto nPolls = statistics.fired[emu::Superinstruction::PollDelayTimer];
+		ASSERT_EQ(nPolls, 2);
+		ASSERT_EQ(statistics.fired[emu::Superinstruction::AddAndSkipIfEqual], 4);
+		ASSERT_EQ(statistics.fired[emu::Superinstruction::SetIndexAndDraw], 1);
+		ASSERT_EQ(statistics.dispatchesSaved, 2 * nPolls - 1 + 4 + 1);
+
+		std::ostringstream report;
+		report << statistics;
+		ASSERT_NE(report.str().find("Fx07+3xkk+1nnn: 2"), std::string::npos);
+	}
+
+	// off by default: nothing fires
+	Chip8 chip8;
+	ASSERT_FALSE(chip8.AreSuperinstructionsEnabled());
+	chip8._ram.Load(program);
+	ASSERT_EQ(chip8.RunCycles(20).cycles, 20) << chip8.GetLastError();
+	ASSERT_EQ(chip8.GetSuperinstructionStatistics().dispatchesSaved, 0);
+}
+
+TEST_F(Chip8Tests, CycleRunsWholeSuperinstructions)
+{
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_cpu;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_display;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_keypad;
+	};
+
+	const std::string program = {
+		'\x72', '\x01',	 // 0x200: V2 += 0x01
+		'\x32', '\x04',	 // 0x202: skip if V2 == 0x04
+		'\x12', '\x00',	 // 0x204: jump to 0x200
+		'\xA0', '\x00',	 // 0x206: I = 0x000
+		'\xD0', '\x05',	 // 0x208: draw 5 rows at (V0, V0)
+		'\x12', '\x0A',	 // 0x20A: jump to 0x20A
+	};
+
+	for (const auto useInstructionCache : { true, false })
+	{
+		Chip8 fused;
+		fused.SetInstructionCacheEnabled(useInstructionCache);
+		fused.SetSuperinstructionsEnabled(true);
+		fused._ram.Load(program);
+
+		// 7xkk+3xkk four times, 1nnn three times, then Annn+Dxyn
+		for (size_t i = 0; i < 8; ++i)
+			ASSERT_TRUE(fused.Cycle()) << fused.GetLastError();
+		ASSERT_EQ(fused._cpu._programCounter, 0x20A);
+		ASSERT_EQ(fused.GetLastExecutedInstructionCode(), emu::Instruction::_0xDxyn);
+		ASSERT_EQ(fused.GetSuperinstructionStatistics().fired[emu::Superinstruction::AddAndSkipIfEqual], 4);
+		ASSERT_EQ(fused.GetSuperinstructionStatistics().fired[emu::Superinstruction::SetIndexAndDraw], 1);
+
+		Chip8 interpreter;
+		interpreter.SetInstructionCacheEnabled(useInstructionCache);
+		interpreter._ram.Load(program);
+		for (size_t i = 0; i < 4 * 2 + 3 + 2; ++i)
+			ASSERT_TRUE(interpreter.Cycle()) << interpreter.GetLastError();
+		CheckAreEqual(fused, interpreter);
+	}
+
+	// a batched run stops at a breakpoint in the middle of a superinstruction
+	Chip8 chip8;
+	chip8.SetSuperinstructionsEnabled(true);
+	chip8._ram.Load(program);
+	chip8.SetBreakpoint(0x208, true);
+	const auto result = chip8.RunCycles(100);
+	ASSERT_EQ(result.stopReason, emu::StopReason::Breakpoint);
+	ASSERT_EQ(result.cycles, 4 * 2 + 3 + 1);
+	ASSERT_EQ(chip8._cpu._programCounter, 0x208);
+}
+
+TEST_F(Chip8Tests, TraceRecordsEveryInstruction)
+{
+	if (!emu::TraceRecorder::IsSupported())
+		GTEST_SKIP() << "trace not supported";
+
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+
+	const std::string program = {
+		'\x60', '\x00',	 // 0x200: V0 = 0x00
+		'\xA3', '\x00',	 // 0x202: I = 0x300
+		'\x70', '\x01',	 // 0x204: V0 += 0x01
+		'\x30', '\x03',	 // 0x206: skip if V0 == 0x03
+		'\x12', '\x04',	 // 0x208: jump to 0x204
+		'\x12', '\x0A',	 // 0x20A: jump to 0x20A
+	};
+	// pc, and which register is written
+	static constexpr auto none = emu::TraceRecord::noRegister;
+	const std::vector<std::pair<emu::TwoBytes, emu::Byte>> expected = {
+		{ 0x200, 0x0 },	 { 0x202, none }, { 0x204, 0x0 }, { 0x206, none }, { 0x208, none }, { 0x204, 0x0 },
+		{ 0x206, none }, { 0x208, none }, { 0x204, 0x0 }, { 0x206, none }, { 0x20A, none }, { 0x20A, none },
+	};
+
+	const auto path = std::filesystem::temp_directory_path() / "chip8Tests.trace";
+	// jit blocks are skipped while tracing
+	for (const auto useJit : { false, true })
+	{
+		Chip8 chip8;
+		chip8.SetJitEnabled(useJit);
+		chip8._ram.Load(program);
+		ASSERT_FALSE(chip8.IsTracing());
+		ASSERT_TRUE(chip8.StartTrace(path));
+		ASSERT_TRUE(chip8.IsTracing());
+		ASSERT_EQ(chip8.RunCycles(expected.size()).cycles, expected.size()) << chip8.GetLastError();
+		chip8.StopTrace();
+		ASSERT_FALSE(chip8.IsTracing());
+		ASSERT_EQ(chip8.RunCycles(10).cycles, 10);
+
+		std::vector<emu::TraceRecord> records;
+		ASSERT_TRUE(emu::ReadTrace(path, records));
+		ASSERT_EQ(records.size(), expected.size());
+		for (std::size_t i = 0; i < records.size(); ++i)
+		{
+			ASSERT_EQ(records[i].cycle, i);
+			ASSERT_EQ(records[i].programCounter, expected[i].first) << i;
+			ASSERT_EQ(records[i].instruction, chip8.GetRam().GetAt(expected[i].first) << 8u |
+												  chip8.GetRam().GetAt(expected[i].first + 1u));
+			ASSERT_EQ(records[i].indexRegister, i < 1 ? 0x000 : 0x300);
+			ASSERT_EQ(records[i].registerIndex, expected[i].second);
+		}
+		ASSERT_EQ(records[2].registerValue, 0x01);
+		ASSERT_EQ(records[5].registerValue, 0x02);
+		ASSERT_EQ(records[8].registerValue, 0x03);
+	}
+
+	// a key wait writes V2 only once the key is pressed
+	Chip8 chip8;
+	chip8._ram.Load(std::string { '\xF2', '\x0A' });	// 0x200: V2 = next key pressed
+	ASSERT_TRUE(chip8.StartTrace(path));
+	ASSERT_EQ(chip8.RunCycles(1).stopReason, emu::StopReason::WaitingForKey);
+	chip8.GetKeypad().Press(emu::Keys::Five, true);
+	ASSERT_EQ(chip8.RunCycles(1).cycles, 1);
+	chip8.StopTrace();
+
+	std::vector<emu::TraceRecord> records;
+	ASSERT_TRUE(emu::ReadTrace(path, records));
+	ASSERT_EQ(records.size(), 2);
+	ASSERT_EQ(records[0].registerIndex, none);
+	ASSERT_EQ(records[1].registerIndex, 0x2);
+	ASSERT_EQ(records[1].registerValue, 0x5);
+	std::filesystem::remove(path);
+}
+
+TEST_F(Chip8Tests, ProfileCountsEveryInstruction)
+{
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+
+	const std::string program = {
+		'\x60', '\x00',	 // 0x200: V0 = 0x00
+		'\x70', '\x01',	 // 0x202: V0 += 0x01
+		'\x30', '\x05',	 // 0x204: skip if V0 == 0x05
+		'\x12', '\x02',	 // 0x206: jump to 0x202
+		'\x12', '\x08',	 // 0x208: jump to 0x208
+	};
+
+	// jit blocks are skipped while profiling, superinstructions are profiled one instruction at a time
+	for (const auto mode : { 0, 1, 2 })
+	{
+		Chip8 chip8;
+		chip8.SetSuperinstructionsEnabled(mode == 1);
+		chip8.SetJitEnabled(mode == 2);
+		chip8._ram.Load(program);
+		ASSERT_EQ(chip8.RunCycles(1 + 5 * 2 + 4 * 1 + 10).cycles, 25) << chip8.GetLastError();
+
+		const auto* profile = chip8.GetProfile();
+		if (!isProfilerEnabled)
+		{
+			ASSERT_EQ(profile, nullptr);
+			GTEST_SKIP() << "built without CHIP8_PROFILER";
+		}
+		ASSERT_NE(profile, nullptr);
+		ASSERT_EQ(profile->instructions[emu::Instruction::_0x6xkk].count, 1);
+		ASSERT_EQ(profile->instructions[emu::Instruction::_0x7xkk].count, 5);
+		ASSERT_EQ(profile->instructions[emu::Instruction::_0x3xkk].count, 5);
+		ASSERT_EQ(profile->instructions[emu::Instruction::_0x1nnn].count, 4 + 10);
+		ASSERT_EQ(profile->GetTotal().count, 25);
+		ASSERT_GT(profile->GetTotal().hostCycles, 0);
+
+		ASSERT_EQ(profile->programCounterHits[0x200], 1);
+		ASSERT_EQ(profile->programCounterHits[0x202], 5);
+		ASSERT_EQ(profile->programCounterHits[0x206], 4);
+		ASSERT_EQ(profile->programCounterHits[0x208], 10);
+		ASSERT_EQ(profile->programCounterHits[0x20A], 0);
+
+		chip8.ResetProfile();
+		ASSERT_EQ(profile->GetTotal().count, 0);
+		ASSERT_EQ(chip8.RunCycles(3).cycles, 3);
+		ASSERT_EQ(profile->programCounterHits[0x208], 3);
+	}
+}
+
+TEST_F(Chip8Tests, SamplingProfilerFoldsCallStacks)
+{
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+
+	const std::string program = {
+		'\x22', '\x08',	 // 0x200: call 0x208
+		'\x12', '\x00',	 // 0x202: jump to 0x200
+		'\x00', '\x00',	 // 0x204
+		'\x00', '\x00',	 // 0x206
+		'\x22', '\x0E',	 // 0x208: call 0x20E
+		'\x00', '\xEE',	 // 0x20A: return
+		'\x00', '\x00',	 // 0x20C
+		'\x00', '\xEE',	 // 0x20E: return
+	};
+
+	Chip8 chip8;
+	chip8._ram.Load(program);
+	ASSERT_EQ(chip8.GetSamplingProfiler(), nullptr);
+
+	// after every instruction: each of the 5 states of the loop is sampled once per lap
+	chip8.SetSamplingProfilerEnabled(true, 1);
+	ASSERT_NE(chip8.GetSamplingProfiler(), nullptr);
+	ASSERT_EQ(chip8.RunCycles(50).cycles, 50) << chip8.GetLastError();
+	ASSERT_EQ(chip8.GetSamplingProfiler()->GetSampleCount(), 50);
+
+	std::ostringstream folded;
+	chip8.GetSamplingProfiler()->WriteFolded(folded);
+	ASSERT_EQ(folded.str(), "main;0x200 10\n"
+							"main;0x202 10\n"
+							"main;sub_208;0x208 10\n"
+							"main;sub_208;0x20A 10\n"
+							"main;sub_208;sub_20E;0x20E 10\n");
+
+	// in lockstep with the loop, carried over from one batch to the next
+	chip8.SetSamplingProfilerEnabled(true, 5);
+	for (std::size_t i = 0; i < 25; ++i)
+		ASSERT_EQ(chip8.RunCycles(3).cycles, 3);
+	ASSERT_EQ(chip8.GetSamplingProfiler()->GetSampleCount(), 15);
+	folded.str("");
+	chip8.GetSamplingProfiler()->WriteFolded(folded);
+	ASSERT_EQ(folded.str(), "main;0x200 15\n");
+
+	// breakpoints still stop batched runs where they are
+	chip8.SetBreakpoint(0x20E, true);
+	const auto result = chip8.RunCycles(50);
+	ASSERT_EQ(result.stopReason, emu::StopReason::Breakpoint);
+	ASSERT_EQ(result.cycles, 2);
+
+	chip8.SetSamplingProfilerEnabled(false);
+	ASSERT_EQ(chip8.GetSamplingProfiler(), nullptr);
+}
+
+TEST_F(Chip8Tests, TimersTickAtSixtyHertz)
+{
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_cpu;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+
+	const std::string program = {
+		'\x60', '\xFF',	 // 0x200: V0 = 0xFF
+		'\xF0', '\x15',	 // 0x202: delay timer = V0
+		'\xF0', '\x18',	 // 0x204: sound timer = V0
+		'\x12', '\x06',	 // 0x206: jump to 0x206
+	};
+
+	for (const auto useJit : { false, true })
+	{
+		for (const auto instructionsPerSecond : std::array<std::size_t, 4> { 60, 600, 1000, 6000 })
+		{
+			Chip8 chip8;
+			chip8.SetJitEnabled(useJit);
+			chip8.SetInstructionsPerSecond(instructionsPerSecond);
+			ASSERT_EQ(chip8.GetCyclesPerFrame(), instructionsPerSecond / Chip8::timerFrequency);
+			chip8._ram.Load(program);
+
+			// ticks since power on, after n instructions
+			const auto ticks = [&](const std::size_t n) { return n * Chip8::timerFrequency / instructionsPerSecond; };
+
+			// one second, whatever the batch sizes: the timers are set by the 2nd and 3rd instruction
+			std::size_t cycles = 0;
+			while (cycles < 3 + instructionsPerSecond)
+				cycles += chip8.RunCycles(std::min<std::size_t>(7, 3 + instructionsPerSecond - cycles)).cycles;
+			ASSERT_EQ(chip8._cpu.GetDelayTimer(), 0xFF - (ticks(cycles) - ticks(1)));
+			ASSERT_EQ(chip8._cpu.GetSoundTimer(), 0xFF - (ticks(cycles) - ticks(2)));
+			ASSERT_EQ(ticks(cycles) - ticks(3), Chip8::timerFrequency);
+		}
+	}
+
+	// below one tick per instruction isn't supported
+	Chip8 chip8;
+	chip8.SetInstructionsPerSecond(1);
+	ASSERT_EQ(chip8.GetInstructionsPerSecond(), Chip8::timerFrequency);
+}
+
+TEST_F(Chip8Tests, RunForPacesWithWallClock)
+{
+	struct Chip8: public emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>
+	{
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_cpu;
+		using emu::detail::Chip8<TestCpu, TestRng, emu::Ram, emu::Display, emu::Keypad>::_ram;
+	};
+
+	{
+		const std::string program = {
+			'\x70', '\x01',	 // 0x200: V0 += 0x01
+			'\x12', '\x00',	 // 0x202: jump to 0x200
+		};
+		Chip8 chip8;
+		chip8.SetInstructionsPerSecond(1000);
+		chip8._ram.Load(program);
+
+		// fractions of an instruction are carried over
+		std::size_t cycles = 0;
+		for (std::size_t i = 0; i < 30; ++i)
+			cycles += chip8.RunFor(std::chrono::microseconds(1500)).cycles;
+		ASSERT_EQ(cycles, 45);
+
+		// long stalls aren't caught up with
+		ASSERT_EQ(chip8.RunFor(std::chrono::seconds(10)).cycles, 250);
+	}
+
+	{
+		const std::string program = {
+			'\x60', '\x3C',	 // 0x200: V0 = 0x3C
+			'\xF0', '\x15',	 // 0x202: delay timer = V0
+			'\xF1', '\x0A',	 // 0x204: V1 = next key pressed
+			'\x12', '\x06',	 // 0x206: jump to 0x206
+		};
+		Chip8 chip8;
+		chip8._ram.Load(program);
+
+		// the timers keep running while waiting for a key
+		const auto result = chip8.RunFor(std::chrono::milliseconds(100));
+		ASSERT_EQ(result.cycles, chip8.GetInstructionsPerSecond() / 10);
+		ASSERT_EQ(result.stopReason, emu::StopReason::WaitingForKey);
+		ASSERT_EQ(chip8._cpu._programCounter, 0x204);
+		ASSERT_EQ(chip8._cpu.GetDelayTimer(), 0x3C - 6);
+
+		// RunCycles stops at every Fx0A, RunCyclesThroughKeyWaits replays it
+		ASSERT_EQ(chip8.RunCycles(100).cycles, 1);
+		const auto throughKeyWaits = chip8.RunCyclesThroughKeyWaits(100);
+		ASSERT_EQ(throughKeyWaits.cycles, 100);
+		ASSERT_EQ(throughKeyWaits.stopReason, emu::StopReason::WaitingForKey);
+		ASSERT_EQ(chip8._cpu._programCounter, 0x204);
+	}
+}
+
 TEST_F(Chip8Tests, PrintError)
 {
 	for (size_t err = emu::Error::START; err <= emu::Error::END; ++err)
@@ -785,6 +1591,60 @@ TEST_F(Chip8Tests, PrintInstruction)
 	}
 }
 
+TEST_F(Chip8Tests, DecodeMatchesInstructionSetIds)
+{
+	const auto matches = [](const std::string_view pattern, const emu::TwoBytes instruction)
+	{
+		// pattern is "0x" followed by 4 nibbles, where lowercase letters are wildcards
+		for (size_t i = 0; i < 4; ++i)
+		{
+			const auto c = pattern[2 + i];
+			if (c >= 'a' && c <= 'z')
+				continue;
+
+			const auto nibble = (instruction >> (4 * (3 - i))) & 0xFu;
+			if (std::stoul(std::string(1, c), nullptr, 16) != nibble)
+				return false;
+		}
+		return true;
+	};
+
+	for (size_t i = 0; i <= 0xFFFF; ++i)
+	{
+		const auto instruction = static_cast<emu::TwoBytes>(i);
+		for (size_t instr = emu::Instruction::START; instr < emu::Instruction::END; ++instr)
+		{
+			if (matches(emu::instructionSetIds[instr], instruction))
+			{
+				ASSERT_EQ(emu::Decode(instruction), instr) << std::hex << instruction;
+			}
+		}
+	}
+
+	ASSERT_EQ(emu::Decode(0x00EF), emu::Instruction::END);
+	ASSERT_EQ(emu::Decode(0x81aF), emu::Instruction::END);
+	ASSERT_EQ(emu::Decode(0xE09F), emu::Instruction::END);
+	ASSERT_EQ(emu::Decode(0xFD68), emu::Instruction::END);
+	ASSERT_EQ(emu::Decode(0xFDFF), emu::Instruction::END);
+}
+
+TEST_F(Chip8Tests, DecodeTable)
+{
+	for (size_t i = 0; i <= 0xFFFF; ++i)
+	{
+		const auto instruction = static_cast<emu::TwoBytes>(i);
+		const auto& decodedInstruction = emu::decodeTable[i];
+
+		ASSERT_EQ(decodedInstruction.code, emu::Decode(instruction));
+		ASSERT_EQ(decodedInstruction.opcode.instruction, instruction);
+		ASSERT_EQ(decodedInstruction.opcode.nnn, utils::LowerTwelveBits(instruction));
+		ASSERT_EQ(decodedInstruction.opcode.x, utils::LowerFourBitsHighByte(instruction));
+		ASSERT_EQ(decodedInstruction.opcode.y, utils::UpperFourBitsLowByte(instruction));
+		ASSERT_EQ(decodedInstruction.opcode.n, utils::LowestFourBits(instruction));
+		ASSERT_EQ(decodedInstruction.opcode.kk, utils::LowestByte(instruction));
+	}
+}
+
 TEST_F(Chip8Tests, CheckTestKeypad)
 {
 	TestChip8 chip8;
@@ -1,5 +1,6 @@
 
 #include "Emulator/Cpu.h"
+#include "Emulator/Display.h"
 #include "Emulator/Interfaces/IDisplay.h"
 #include "Emulator/Interfaces/IKeypad.h"
 #include "Emulator/Interfaces/IRam.h"
@@ -16,6 +17,7 @@
 #endif
 
 #include <gtest/gtest.h>
+#include <random>
 
 struct TestKeyPad final: public emu::IKeypad
 {
@@ -751,6 +753,37 @@ TEST_F(CpuTests, Draw)
 	}
 }
 
+TEST_F(CpuTests, DrawRowBlitterMatchesPerPixelDraw)
+{
+	TestRam ram;
+	ram.data.resize(0x1000);
+
+	std::mt19937 generator(1234);
+	for (auto& byte : ram.data)
+		byte = static_cast<emu::Byte>(generator() & 0xFF);
+
+	// emu::Display goes through XorRow, while the IDisplay interface falls back to the per-pixel loop
+	emu::Display blitted;
+	emu::Display drawn;
+	TestCpu blitter;
+	TestCpu reference;
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		// VF included, as it's reset before reading the coordinates
+		for (size_t reg = 0; reg < blitter._registers.size(); ++reg)
+			blitter._registers[reg] = reference._registers[reg] = static_cast<emu::Byte>(generator() & 0xFF);
+		blitter._indexRegister = reference._indexRegister = static_cast<emu::TwoBytes>(generator() % 0xFF0);
+
+		const auto instruction = static_cast<emu::TwoBytes>(0xD000 | (generator() & 0x0FFF));
+		blitter.Draw(instruction, blitted, ram);
+		reference.Draw(instruction, static_cast<emu::IDisplay&>(drawn), ram);
+
+		ASSERT_EQ(blitter._registers.back(), reference._registers.back());
+		for (size_t coord = 0; coord < blitted.GetWidth() * blitted.GetHeight(); ++coord)
+			ASSERT_EQ(blitted.GetAt(coord), drawn.GetAt(coord)) << i << " " << coord;
+	}
+}
+
 TEST_F(CpuTests, WaitUntilKeyIsPressed)
 {
 	TestCpu cpu;
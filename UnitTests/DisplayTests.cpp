@@ -79,3 +79,69 @@ TEST_F(DisplayTests, Serialize)
 	for (size_t i = 0; i < display.GetWidth() * display.GetHeight(); ++i)
 		ASSERT_EQ(display.GetAt(i), display2.GetAt(i));
 }
+TEST_F(DisplayTests, GetRows)
+{
+	emu::Display display;
+	ASSERT_EQ(display.GetRows().size(), display.GetHeight());
+	for (size_t i = 24; i < 128; ++i)
+		display.FlipAt(i);
+
+	const auto rows = display.GetRows();
+	ASSERT_EQ(rows[0], ~std::uint64_t { 0 } << 24);
+	ASSERT_EQ(rows[1], ~std::uint64_t { 0 });
+	for (size_t y = 2; y < rows.size(); ++y)
+		ASSERT_EQ(rows[y], 0);
+
+	display.Clear();
+	for (size_t y = 0; y < rows.size(); ++y)
+		ASSERT_EQ(rows[y], 0);
+}
+TEST_F(DisplayTests, SerializeLayout)
+{
+	emu::Display display;
+	display.FlipAt(0);
+	display.FlipAt(9);
+	display.FlipAt(64 * 31 + 63);
+
+	std::vector<emu::Byte> bytes;
+	display.Serialize(bytes);
+
+	// pixel i is bit (i & 7) of byte (i >> 3)
+	ASSERT_EQ(bytes.size(), display.GetWidth() * display.GetHeight() / 8);
+	for (size_t i = 0; i < bytes.size(); ++i)
+	{
+		if (i == 0)
+			ASSERT_EQ(bytes[i], 0x01);
+		else if (i == 1)
+			ASSERT_EQ(bytes[i], 0x02);
+		else if (i == bytes.size() - 1)
+			ASSERT_EQ(bytes[i], 0x80);
+		else
+			ASSERT_EQ(bytes[i], 0x00);
+	}
+}
+TEST_F(DisplayTests, ConsumeDirtyRegions)
+{
+	emu::Display display;
+	ASSERT_EQ(display.ConsumeDirtyRegions(), 0);
+
+	display.FlipAt(3);
+	display.FlipAt(64 * 5 + 10);
+	ASSERT_TRUE(display.XorRow(5, 0x400));
+	ASSERT_FALSE(display.XorRow(31, 0x0));
+	ASSERT_FALSE(display.XorRow(30, 0x1));
+	ASSERT_EQ(display.ConsumeDirtyRegions(), (1u << 0) | (1u << 5) | (1u << 30));
+	ASSERT_EQ(display.ConsumeDirtyRegions(), 0);
+
+	// consuming doesn't reset HasChanged, and vice versa
+	ASSERT_TRUE(display.HasChanged());
+	display.Reset();
+	display.Clear();
+	display.Reset();
+	ASSERT_EQ(display.ConsumeDirtyRegions(), ~std::uint32_t { 0 });
+
+	std::vector<emu::Byte> bytes;
+	display.Serialize(bytes);
+	display.Deserialize(bytes);
+	ASSERT_EQ(display.ConsumeDirtyRegions(), ~std::uint32_t { 0 });
+}
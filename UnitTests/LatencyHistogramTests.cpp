@@ -0,0 +1,86 @@
+
+#include "Emulator/LatencyHistogram.h"
+
+#include <gtest/gtest.h>
+
+class LatencyHistogramTests: public ::testing::Test
+{
+};
+
+TEST_F(LatencyHistogramTests, Empty)
+{
+	utils::LatencyHistogram histogram{};
+	ASSERT_EQ(histogram.GetCount(), 0u);
+	ASSERT_EQ(histogram.GetMin(), 0u);
+	ASSERT_EQ(histogram.GetMax(), 0u);
+	ASSERT_DOUBLE_EQ(histogram.GetMean(), 0.0);
+	ASSERT_EQ(histogram.GetPercentile(50.0), 0u);
+}
+
+TEST_F(LatencyHistogramTests, BucketsCoverEveryValue)
+{
+	using utils::LatencyHistogram;
+	ASSERT_EQ(LatencyHistogram::GetBucket(0), 0u);
+	ASSERT_EQ(LatencyHistogram::GetBucket(31), 31u);
+	ASSERT_EQ(LatencyHistogram::GetBucket(32), 32u);
+	ASSERT_EQ(LatencyHistogram::GetBucket(~std::uint64_t { 0 }), LatencyHistogram::nBuckets - 1);
+	ASSERT_EQ(LatencyHistogram::GetBucketUpperBound(LatencyHistogram::nBuckets - 1), ~std::uint64_t { 0 });
+
+	// contiguous, and each value's bucket bounds it
+	for (std::uint64_t value = 1; value < (1u << 16u); ++value)
+	{
+		const auto bucket = LatencyHistogram::GetBucket(value);
+		ASSERT_GE(LatencyHistogram::GetBucketUpperBound(bucket), value);
+		ASSERT_LT(LatencyHistogram::GetBucketUpperBound(bucket - 1), value);
+	}
+}
+
+TEST_F(LatencyHistogramTests, Percentiles)
+{
+	utils::LatencyHistogram histogram{};
+	for (std::uint64_t value = 1; value <= 10000; ++value)
+		histogram.Record(value);
+
+	ASSERT_EQ(histogram.GetCount(), 10000u);
+	ASSERT_EQ(histogram.GetMin(), 1u);
+	ASSERT_EQ(histogram.GetMax(), 10000u);
+	ASSERT_DOUBLE_EQ(histogram.GetMean(), 5000.5);
+
+	// within the bucket resolution
+	for (const auto percentile : { 50.0, 99.0, 99.9 })
+	{
+		const auto expected = percentile * 100.0;
+		const auto actual = static_cast<double>(histogram.GetPercentile(percentile));
+		ASSERT_GE(actual, expected);
+		ASSERT_LE(actual, expected * (1.0 + 1.0 / utils::LatencyHistogram::subBuckets));
+	}
+	ASSERT_EQ(histogram.GetPercentile(100.0), 10000u);
+	ASSERT_EQ(histogram.GetPercentile(0.0), 1u);
+}
+
+TEST_F(LatencyHistogramTests, Outliers)
+{
+	using utils::LatencyHistogram;
+	LatencyHistogram histogram{};
+	for (std::size_t i = 0; i < 999; ++i)
+		histogram.Record(100);
+	histogram.Record(1000000);
+
+	// the 100s' bucket: the outlier doesn't drag the percentile up
+	ASSERT_LE(histogram.GetPercentile(99.0), LatencyHistogram::GetBucketUpperBound(LatencyHistogram::GetBucket(100)));
+	ASSERT_GE(histogram.GetPercentile(99.99), 1000000u);
+	ASSERT_EQ(histogram.GetMax(), 1000000u);
+}
+
+TEST_F(LatencyHistogramTests, Clear)
+{
+	utils::LatencyHistogram histogram{};
+	histogram.Record(42);
+	histogram.Clear();
+
+	ASSERT_EQ(histogram.GetCount(), 0u);
+	ASSERT_EQ(histogram.GetPercentile(99.0), 0u);
+	histogram.Record(7);
+	ASSERT_EQ(histogram.GetMin(), 7u);
+	ASSERT_EQ(histogram.GetPercentile(50.0), 7u);
+}
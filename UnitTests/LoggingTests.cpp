@@ -1,7 +1,11 @@
 
+// LOG_* go through the cached handle of this logger
+#define LOGGER_NAME "loggerNameCached"
 #include "Emulator/Logging.h"
+#include "Emulator/AsyncRingBufferSink.h"
 
 #include <gtest/gtest.h>
+#include <thread>
 
 class LoggingTests: public ::testing::Test
 {
@@ -46,3 +50,106 @@ TEST_F(LoggingTests, SinkMultiThreaded)
 	ASSERT_EQ(rbSink->GetRingBuffer().Size(), 1);
 	ASSERT_EQ(rbSink->GetRingBuffer().Back().second, std::string(logLine) + "\n");
 }
+
+TEST_F(LoggingTests, CachedLogger)
+{
+	auto rbSink = std::make_shared<utils::RingBufferSinkSt>();
+	std::vector<spdlog::sink_ptr> sinks;
+	sinks.push_back(rbSink);
+	spdlog::register_logger(std::make_shared<spdlog::logger>(LOGGER_NAME, sinks.begin(), sinks.end()));
+
+	spdlog::get(LOGGER_NAME)->set_level(spdlog::level::trace);
+	spdlog::get(LOGGER_NAME)->set_pattern("%v");
+
+	LOG_CRITICAL("first");
+	ASSERT_EQ(rbSink->GetRingBuffer().Size(), 1);
+	ASSERT_EQ(rbSink->GetRingBuffer().Back().second, "first\n");
+
+	// looked up only once: dropping it from the registry doesn't affect LOG_*
+	spdlog::drop(LOGGER_NAME);
+	ASSERT_EQ(spdlog::get(LOGGER_NAME), nullptr);
+	LOG_CRITICAL("second");
+	ASSERT_EQ(rbSink->GetRingBuffer().Size(), 2);
+	ASSERT_EQ(rbSink->GetRingBuffer().Back().second, "second\n");
+
+	// the level is still checked on every call
+	utils::detail::GetLogger()->set_level(spdlog::level::off);
+	LOG_CRITICAL("third");
+	ASSERT_EQ(rbSink->GetRingBuffer().Size(), 2);
+}
+
+TEST_F(LoggingTests, AsyncSink)
+{
+	constexpr const char* loggerName = "loggerNameAsync";
+	auto sink = std::make_shared<utils::AsyncRingBufferSink>();
+	auto logger = std::make_shared<spdlog::logger>(loggerName, sink);
+	logger->set_level(spdlog::level::trace);
+	logger->set_pattern("[%n][%l] %v");
+
+	SPDLOG_LOGGER_WARN(logger, "{} + {} = {}", 1, 2, 3);
+	logger->flush();
+
+	std::vector<utils::AsyncRingBufferSink::Line> lines;
+	sink->GetSnapshot(lines);
+	ASSERT_EQ(lines.size(), 1);
+	ASSERT_EQ(lines[0].first, spdlog::level::warn);
+	ASSERT_EQ(lines[0].second, "[loggerNameAsync][warning] 1 + 2 = 3\n");
+	ASSERT_EQ(sink->GetFormattedCount(), 1);
+
+	// only the tail of the formatted lines is kept
+	for (std::size_t i = 0; i < 2 * utils::AsyncRingBufferSink::ringBufferSize; ++i)
+		SPDLOG_LOGGER_INFO(logger, "{}", i);
+	logger->flush();
+	sink->GetSnapshot(lines);
+	ASSERT_EQ(lines.size(), utils::AsyncRingBufferSink::ringBufferSize);
+	ASSERT_EQ(lines.back().second, "[loggerNameAsync][info] " +
+									   std::to_string(2 * utils::AsyncRingBufferSink::ringBufferSize - 1) + "\n");
+
+	sink->Clear();
+	sink->GetSnapshot(lines);
+	ASSERT_TRUE(lines.empty());
+}
+
+TEST_F(LoggingTests, AsyncSinkTruncatesLongPayloads)
+{
+	auto sink = std::make_shared<utils::AsyncRingBufferSink>();
+	auto logger = std::make_shared<spdlog::logger>("loggerNameAsyncTruncated", sink);
+	logger->set_pattern("%v");
+
+	const std::string payload(2 * utils::detail::LogSlot::maxPayloadSize, 'x');
+	SPDLOG_LOGGER_CRITICAL(logger, payload);
+	logger->flush();
+
+	std::vector<utils::AsyncRingBufferSink::Line> lines;
+	sink->GetSnapshot(lines);
+	ASSERT_EQ(lines.size(), 1);
+	ASSERT_EQ(lines[0].second, payload.substr(0, utils::detail::LogSlot::maxPayloadSize) + "\n");
+	ASSERT_EQ(sink->GetTruncatedCount(), 1);
+	ASSERT_EQ(sink->GetDroppedCount(), 0);
+}
+
+TEST_F(LoggingTests, AsyncSinkMultipleThreads)
+{
+	static constexpr std::size_t nThreads = 4;
+	static constexpr std::size_t nRecords = 10'000;
+
+	auto sink = std::make_shared<utils::AsyncRingBufferSink>();
+	auto logger = std::make_shared<spdlog::logger>("loggerNameAsyncMt", sink);
+	logger->set_pattern("%v");
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < nThreads; ++i)
+		threads.emplace_back(
+			[&]
+			{
+				for (std::size_t j = 0; j < nRecords; ++j)
+					SPDLOG_LOGGER_CRITICAL(logger, "{}", j);
+			});
+	for (auto& thread : threads)
+		thread.join();
+	logger->flush();
+
+	// whatever didn't fit in the queue is counted as dropped
+	ASSERT_EQ(sink->GetFormattedCount() + sink->GetDroppedCount(), nThreads * nRecords);
+	ASSERT_GT(sink->GetFormattedCount(), 0);
+}
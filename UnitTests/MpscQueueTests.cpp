@@ -0,0 +1,89 @@
+
+#include <gtest/gtest.h>
+#include "Emulator/MpscQueue.h"
+
+#include <thread>
+#include <vector>
+
+class MpscQueueTests: public ::testing::Test
+{
+public:
+	static constexpr std::size_t queueSize = 16;
+	using MpscQueue = utils::MpscQueue<std::size_t, queueSize>;
+};
+
+TEST_F(MpscQueueTests, PushUntilFullThenPopUntilEmpty)
+{
+	MpscQueue queue {};
+	ASSERT_EQ(queue.MaxSize(), queueSize);
+	ASSERT_TRUE(queue.Empty());
+
+	for (std::size_t i = 0; i < queue.MaxSize(); ++i)
+		ASSERT_TRUE(queue.TryPush(i));
+	ASSERT_FALSE(queue.TryPush(queue.MaxSize()));
+	ASSERT_FALSE(queue.Empty());
+
+	std::size_t item = 0;
+	for (std::size_t i = 0; i < queue.MaxSize(); ++i)
+	{
+		ASSERT_TRUE(queue.TryPop(item));
+		ASSERT_EQ(item, i);
+	}
+	ASSERT_FALSE(queue.TryPop(item));
+	ASSERT_TRUE(queue.Empty());
+}
+
+TEST_F(MpscQueueTests, WrapAround)
+{
+	MpscQueue queue {};
+	std::size_t item = 0;
+	for (std::size_t i = 0; i < 10 * queueSize; ++i)
+	{
+		ASSERT_TRUE(queue.TryPush(i));
+		ASSERT_TRUE(queue.TryPush(i + 1));
+		ASSERT_TRUE(queue.TryPop(item));
+		ASSERT_EQ(item, i);
+		ASSERT_TRUE(queue.TryPop(item));
+		ASSERT_EQ(item, i + 1);
+	}
+	ASSERT_TRUE(queue.Empty());
+}
+
+TEST_F(MpscQueueTests, ProducersAndConsumerThreads)
+{
+	static constexpr std::size_t nProducers = 4;
+	static constexpr std::size_t nItems = 25'000;
+
+	MpscQueue queue {};
+	std::vector<std::thread> producers;
+	for (std::size_t producer = 0; producer < nProducers; ++producer)
+	{
+		producers.emplace_back(
+			[&queue, producer]
+			{
+				for (std::size_t i = 0; i < nItems; ++i)
+					while (!queue.TryPush(producer * nItems + i))
+						std::this_thread::yield();
+			});
+	}
+
+	// every item arrives exactly once, in order for each producer
+	std::vector<std::size_t> expected(nProducers, 0);
+	std::size_t item = 0;
+	for (std::size_t nPopped = 0; nPopped < nProducers * nItems;)
+	{
+		if (!queue.TryPop(item))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		const auto producer = item / nItems;
+		ASSERT_LT(producer, nProducers);
+		ASSERT_EQ(item % nItems, expected[producer]);
+		++expected[producer];
+		++nPopped;
+	}
+	for (auto& producer : producers)
+		producer.join();
+	ASSERT_TRUE(queue.Empty());
+}
@@ -29,6 +29,9 @@ TEST_F(RingBufferTests, PushBackUntilCapacity)
 	ASSERT_EQ(rb.Size(), rb.MaxSize());
 	for (size_t i = 0; i < rb.Size(); ++i)
 		ASSERT_EQ(i, rb[i]);
+	const auto& constRb = rb;
+	for (size_t i = 0; i < constRb.Size(); ++i)
+		ASSERT_EQ(i, constRb[i]);
 
 	__START_IGNORING_WARNINGS__
 #ifdef __clang__
@@ -21,6 +21,15 @@ TEST_F(RngTests, InitializationWithSeed)
 	ASSERT_LE(rng.Next(), std::numeric_limits<emu::Byte>::max());
 }
 
+TEST_F(RngTests, SeedRestartsTheSequence)
+{
+	emu::Rng seeded(1234);
+	emu::Rng rng;
+	rng.Seed(1234);
+	for (size_t i = 0; i < 100; ++i)
+		ASSERT_EQ(rng.Next(), seeded.Next()) << i;
+}
+
 TEST_F(RngTests, InitializationWithSeedConsistentValues)
 {
 	emu::Rng rng(1234);
@@ -0,0 +1,79 @@
+
+#include <gtest/gtest.h>
+#include "Emulator/SpscQueue.h"
+
+#include <thread>
+
+class SpscQueueTests: public ::testing::Test
+{
+public:
+	static constexpr std::size_t queueSize = 16;
+	using SpscQueue = utils::SpscQueue<std::size_t, queueSize>;
+};
+
+TEST_F(SpscQueueTests, PushUntilFullThenPopUntilEmpty)
+{
+	SpscQueue queue {};
+	ASSERT_EQ(queue.MaxSize(), queueSize - 1);
+	ASSERT_TRUE(queue.Empty());
+
+	for (std::size_t i = 0; i < queue.MaxSize(); ++i)
+		ASSERT_TRUE(queue.TryPush(i));
+	ASSERT_FALSE(queue.TryPush(queue.MaxSize()));
+	ASSERT_FALSE(queue.Empty());
+
+	std::size_t item = 0;
+	for (std::size_t i = 0; i < queue.MaxSize(); ++i)
+	{
+		ASSERT_TRUE(queue.TryPop(item));
+		ASSERT_EQ(item, i);
+	}
+	ASSERT_FALSE(queue.TryPop(item));
+	ASSERT_TRUE(queue.Empty());
+}
+
+TEST_F(SpscQueueTests, WrapAround)
+{
+	SpscQueue queue {};
+	std::size_t item = 0;
+	for (std::size_t i = 0; i < 10 * queueSize; ++i)
+	{
+		ASSERT_TRUE(queue.TryPush(i));
+		ASSERT_TRUE(queue.TryPush(i + 1));
+		ASSERT_TRUE(queue.TryPop(item));
+		ASSERT_EQ(item, i);
+		ASSERT_TRUE(queue.TryPop(item));
+		ASSERT_EQ(item, i + 1);
+	}
+	ASSERT_TRUE(queue.Empty());
+}
+
+TEST_F(SpscQueueTests, ProducerAndConsumerThreads)
+{
+	static constexpr std::size_t nItems = 100'000;
+
+	SpscQueue queue {};
+	std::thread producer(
+		[&]
+		{
+			for (std::size_t i = 0; i < nItems; ++i)
+				while (!queue.TryPush(i))
+					std::this_thread::yield();
+		});
+
+	// every item arrives exactly once, in order
+	std::size_t expected = 0;
+	std::size_t item = 0;
+	while (expected < nItems)
+	{
+		if (!queue.TryPop(item))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		ASSERT_EQ(item, expected);
+		++expected;
+	}
+	producer.join();
+	ASSERT_TRUE(queue.Empty());
+}
@@ -47,3 +47,46 @@ TEST_F(StopwatchTests, Measurements)
 	ASSERT_DOUBLE_EQ(sw.GetMilliSeconds(), ns * 1e-6);
 	ASSERT_DOUBLE_EQ(sw.GetSeconds(), ns * 1e-9);
 }
+
+TEST_F(StopwatchTests, TscStartAtCreation)
+{
+	utils::TscStopWatch sw{};
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	sw.Stop();
+
+	ASSERT_GT(sw.GetTicks(), 0u);
+	ASSERT_GT(sw.GetNanoSeconds(), 0.0);
+}
+
+TEST_F(StopwatchTests, TscDelayedStart)
+{
+	utils::TscStopWatch sw(false);
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	ASSERT_EQ(sw.GetTicks(), 0u);
+	ASSERT_DOUBLE_EQ(sw.GetNanoSeconds(), 0.0);
+}
+
+TEST_F(StopwatchTests, TscAgreesWithClock)
+{
+	utils::StopWatch clockSw{};
+	utils::TscStopWatch tscSw{};
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	tscSw.Stop();
+	clockSw.Stop();
+
+	// within 10%: the calibration takes a few ms, and sleeping isn't exact
+	ASSERT_NEAR(tscSw.GetNanoSeconds(), clockSw.GetNanoSeconds(), 0.1 * clockSw.GetNanoSeconds());
+}
+
+TEST_F(StopwatchTests, TscMeasurements)
+{
+	utils::TscStopWatch sw{};
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	sw.Stop();
+
+	const auto ns = sw.GetNanoSeconds();
+	ASSERT_DOUBLE_EQ(sw.GetMicroSeconds(), ns * 1e-3);
+	ASSERT_DOUBLE_EQ(sw.GetMilliSeconds(), ns * 1e-6);
+	ASSERT_DOUBLE_EQ(sw.GetSeconds(), ns * 1e-9);
+}
@@ -0,0 +1,54 @@
+
+#include "Emulator/ThroughputMeter.h"
+
+#include <gtest/gtest.h>
+
+class ThroughputMeterTests: public ::testing::Test
+{
+public:
+	static std::uint64_t GetTicks(const double seconds)
+	{
+		return static_cast<std::uint64_t>(seconds * utils::GetTimeStampCounterFrequency());
+	}
+};
+
+TEST_F(ThroughputMeterTests, Empty)
+{
+	utils::ThroughputMeter meter{};
+	ASSERT_DOUBLE_EQ(meter.GetItemsPerSecond(), 0.0);
+}
+
+TEST_F(ThroughputMeterTests, AveragesOverTheWindow)
+{
+	utils::ThroughputMeter meter(1.0);
+	const auto start = GetTicks(10.0);
+	// 1000 items/s, then 3000 items/s, for as long
+	meter.Add(1000, GetTicks(0.1), start);
+	meter.Add(3000, GetTicks(0.1), start + GetTicks(0.1));
+
+	ASSERT_NEAR(meter.GetItemsPerSecond(), 20000.0, 20000.0 * 1e-6);
+}
+
+TEST_F(ThroughputMeterTests, ForgetsOldBatches)
+{
+	utils::ThroughputMeter meter(1.0);
+	const auto start = GetTicks(10.0);
+	meter.Add(1000, GetTicks(0.1), start);
+	meter.Add(500, GetTicks(0.1), start + GetTicks(2.0));
+
+	ASSERT_NEAR(meter.GetItemsPerSecond(), 5000.0, 5000.0 * 1e-6);
+
+	meter.Clear();
+	ASSERT_DOUBLE_EQ(meter.GetItemsPerSecond(), 0.0);
+}
+
+TEST_F(ThroughputMeterTests, BoundedBatches)
+{
+	utils::ThroughputMeter meter(1.0);
+	const auto start = GetTicks(10.0);
+	for (std::size_t i = 0; i < 2 * utils::ThroughputMeter::maxBatches; ++i)
+		meter.Add(i < utils::ThroughputMeter::maxBatches ? 1 : 2, GetTicks(1e-6), start + i);
+
+	// only the last maxBatches are left
+	ASSERT_NEAR(meter.GetItemsPerSecond(), 2e6, 2e6 * 1e-3);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "Emulator/Trace.h"
+
+#include <fstream>
+
+class TraceTests: public ::testing::Test
+{
+public:
+	void SetUp() override
+	{
+		if (!emu::TraceRecorder::IsSupported())
+			GTEST_SKIP() << "trace not supported";
+	}
+	void TearDown() override { std::filesystem::remove(path); }
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "chip8TraceTests.trace";
+};
+
+TEST_F(TraceTests, RecordAndRead)
+{
+	emu::TraceRecorder recorder;
+	ASSERT_FALSE(recorder.IsOpen());
+	ASSERT_TRUE(recorder.Open(path, 16));
+	ASSERT_TRUE(recorder.IsOpen());
+	for (std::size_t i = 0; i < 10; ++i)
+		recorder.Record(static_cast<emu::TwoBytes>(0x200 + 2 * i), 0x6A02, 0x300, 0xA, static_cast<emu::Byte>(i));
+	ASSERT_EQ(recorder.GetRecordCount(), 10);
+
+	// readable while still recording
+	std::vector<emu::TraceRecord> records;
+	ASSERT_TRUE(emu::ReadTrace(path, records));
+	ASSERT_EQ(records.size(), 10);
+	for (std::size_t i = 0; i < records.size(); ++i)
+	{
+		ASSERT_EQ(records[i].cycle, i);
+		ASSERT_EQ(records[i].programCounter, 0x200 + 2 * i);
+		ASSERT_EQ(records[i].instruction, 0x6A02);
+		ASSERT_EQ(records[i].indexRegister, 0x300);
+		ASSERT_EQ(records[i].registerIndex, 0xA);
+		ASSERT_EQ(records[i].registerValue, i);
+	}
+
+	recorder.Close();
+	ASSERT_FALSE(recorder.IsOpen());
+	ASSERT_TRUE(emu::ReadTrace(path, records));
+	ASSERT_EQ(records.size(), 10);
+}
+
+TEST_F(TraceTests, KeepsTheLastRecords)
+{
+	static constexpr std::size_t capacity = 8;
+	static constexpr std::size_t nRecords = 21;
+
+	{
+		emu::TraceRecorder recorder;
+		ASSERT_TRUE(recorder.Open(path, capacity));
+		for (std::size_t i = 0; i < nRecords; ++i)
+			recorder.Record(static_cast<emu::TwoBytes>(i), 0x1200, 0, emu::TraceRecord::noRegister, 0);
+	}
+
+	std::vector<emu::TraceRecord> records;
+	ASSERT_TRUE(emu::ReadTrace(path, records));
+	ASSERT_EQ(records.size(), capacity);
+	for (std::size_t i = 0; i < records.size(); ++i)
+	{
+		ASSERT_EQ(records[i].cycle, nRecords - capacity + i);
+		ASSERT_EQ(records[i].programCounter, nRecords - capacity + i);
+	}
+}
+
+TEST_F(TraceTests, InvalidFiles)
+{
+	emu::TraceRecorder recorder;
+	ASSERT_FALSE(recorder.Open(path, 0));
+	ASSERT_FALSE(recorder.Open(path / "notADirectory" / "trace"));
+
+	std::vector<emu::TraceRecord> records;
+	ASSERT_FALSE(emu::ReadTrace(path / "missing", records));
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << "not a trace file, but longer than the header";
+	}
+	ASSERT_FALSE(emu::ReadTrace(path, records));
+	ASSERT_TRUE(records.empty());
+}
+
+TEST_F(TraceTests, WrittenRegister)
+{
+	ASSERT_EQ(emu::GetWrittenRegister(emu::Instruction::_0x6xkk, 0x6A02), 0xA);
+	ASSERT_EQ(emu::GetWrittenRegister(emu::Instruction::_0x8xy4, 0x8124), 0x1);
+	ASSERT_EQ(emu::GetWrittenRegister(emu::Instruction::_0xFx65, 0xF365), 0x3);
+	ASSERT_EQ(emu::GetWrittenRegister(emu::Instruction::_0xDxyn, 0xD125), 0xF);
+	ASSERT_EQ(emu::GetWrittenRegister(emu::Instruction::_0x1nnn, 0x1200), emu::TraceRecord::noRegister);
+	ASSERT_EQ(emu::GetWrittenRegister(emu::Instruction::_0xFx55, 0xF355), emu::TraceRecord::noRegister);
+	ASSERT_EQ(emu::GetWrittenRegister(emu::Instruction::_0xFx0A, 0xF20A), 0x2);
+	ASSERT_EQ(emu::GetWrittenRegister(emu::Instruction::_0xFx0A, 0xF20A, true), emu::TraceRecord::noRegister);
+}
@@ -0,0 +1,75 @@
+
+#include <gtest/gtest.h>
+#include "Emulator/TripleBuffer.h"
+
+#include <array>
+#include <thread>
+
+class TripleBufferTests: public ::testing::Test
+{
+public:
+	using Frame = std::array<std::size_t, 32>;
+	using TripleBuffer = utils::TripleBuffer<Frame>;
+};
+
+TEST_F(TripleBufferTests, ConsumerSeesTheLatestPublishedBuffer)
+{
+	TripleBuffer buffer {};
+	ASSERT_FALSE(buffer.Update());
+	ASSERT_EQ(buffer.GetFrontBuffer()[0], 0);
+
+	buffer.GetBackBuffer()[0] = 1;
+	buffer.Publish();
+	ASSERT_TRUE(buffer.Update());
+	ASSERT_EQ(buffer.GetFrontBuffer()[0], 1);
+	ASSERT_FALSE(buffer.Update());
+	ASSERT_EQ(buffer.GetFrontBuffer()[0], 1);
+
+	// the consumer only gets the last of the ones published in the meantime
+	for (std::size_t i = 2; i < 10; ++i)
+	{
+		buffer.GetBackBuffer()[0] = i;
+		buffer.Publish();
+	}
+	ASSERT_TRUE(buffer.Update());
+	ASSERT_EQ(buffer.GetFrontBuffer()[0], 9);
+
+	// the producer never writes into the front buffer
+	buffer.GetBackBuffer()[0] = 10;
+	ASSERT_EQ(buffer.GetFrontBuffer()[0], 9);
+}
+
+TEST_F(TripleBufferTests, ProducerAndConsumerThreads)
+{
+	static constexpr std::size_t nFrames = 200'000;
+
+	TripleBuffer buffer {};
+	std::thread producer(
+		[&]
+		{
+			for (std::size_t i = 1; i <= nFrames; ++i)
+			{
+				auto& frame = buffer.GetBackBuffer();
+				frame.fill(i);
+				buffer.Publish();
+			}
+		});
+
+	// frames are never torn, and never go back in time
+	std::size_t last = 0;
+	while (last < nFrames)
+	{
+		if (!buffer.Update())
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		const auto& frame = buffer.GetFrontBuffer();
+		for (const auto x : frame)
+			ASSERT_EQ(x, frame[0]);
+		ASSERT_GT(frame[0], last);
+		last = frame[0];
+	}
+	producer.join();
+}
@@ -155,3 +155,30 @@ TEST_F(UtilityTests, GetBitAt)
 	ASSERT_EQ(utils::GetBitAt<6>(value), 0x02);
 	ASSERT_EQ(utils::GetBitAt<7>(value), 0x01);
 }
+
+TEST_F(UtilityTests, Fnv1a)
+{
+	// reference values from the FNV test suite
+	static_assert(utils::Fnv1a(nullptr, 0) == 0xcbf29ce484222325ull);
+	const emu::Byte a = 'a';
+	ASSERT_EQ(utils::Fnv1a(&a, 1), 0xaf63dc4c8601ec8cull);
+	const std::array<emu::Byte, 6> foobar = { 'f', 'o', 'o', 'b', 'a', 'r' };
+	ASSERT_EQ(utils::Fnv1a(foobar.data(), foobar.size()), 0x85944171f73967e8ull);
+
+	// incremental
+	ASSERT_EQ(utils::Fnv1a(foobar.data() + 3, 3, utils::Fnv1a(foobar.data(), 3)),
+			  utils::Fnv1a(foobar.data(), foobar.size()));
+}
+
+TEST_F(UtilityTests, ExpandBits)
+{
+	std::array<std::uint32_t, 64> out {};
+	const std::uint64_t bits = 0x8000'0000'0000'00A5ull;
+	utils::ExpandBits(bits, out.data());
+	for (std::size_t i = 0; i < out.size(); ++i)
+		ASSERT_EQ(out[i], (bits >> i) & 1u ? 0xFFFFFFFFu : 0u) << i;
+
+	utils::ExpandBits(std::uint64_t { 0 }, out.data());
+	for (const auto x : out)
+		ASSERT_EQ(x, 0u);
+}
@@ -48,6 +48,8 @@
 
 __START_IGNORING_WARNINGS__
 __IGNORE_MAHI_GUI_WARNINGS__
+// before anything including the OpenGL headers
+#include <glad/glad.h>
 #include <Mahi/Gui.hpp>
 #include <Mahi/Gui/Native.hpp>
 #include <Mahi/Util/Timing/Frequency.hpp>
@@ -57,12 +59,19 @@ __STOP_IGNORING_WARNINGS__
 #define LOGGER_NAME "ringBuffer"
 #include "Emulator/Logging.h"
 
+#include "Emulator/AsyncRingBufferSink.h"
 #include "Emulator/Chip8.h"
-#include "Emulator/RingBuffer.h"
+#include "Emulator/LatencyHistogram.h"
+#include "Emulator/SpscQueue.h"
 #include "Emulator/Stopwatch.h"
+#include "Emulator/ThroughputMeter.h"
+#include "Emulator/TripleBuffer.h"
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <thread>
+#include <utility>
 
 enum class SaveStateOperation
 {
@@ -80,9 +89,10 @@ static const std::unordered_map<spdlog::level::level_enum, mahi::gui::Color> log
 
 static auto RegisterRingBufferSink()
 {
-	auto rbSink = std::make_shared<utils::RingBufferSinkSt>();
+	// the emulator logs from its own thread: it only queues the records, which are formatted in the background
+	auto rbSink = std::make_shared<utils::AsyncRingBufferSink>();
 	std::vector<spdlog::sink_ptr> sinks;
-	sinks.push_back(std::make_shared<spdlog::sinks::stdout_sink_st>());
+	sinks.push_back(std::make_shared<spdlog::sinks::stdout_sink_mt>());
 	sinks.push_back(rbSink);
 	spdlog::register_logger(std::make_shared<spdlog::logger>(LOGGER_NAME, sinks.begin(), sinks.end()));
 
@@ -285,6 +295,221 @@ namespace ImGui
 	}
 }	 // namespace ImGui
 
+// owns the Chip8 and runs it on its own thread, so that neither the emulation speed nor the input latency depend on
+// the GUI frame time: keys come in through a lock-free queue, and frames go out through a lock-free triple buffer
+class EmulatorThread
+{
+public:
+	static constexpr std::size_t displayWidth = 8 * sizeof(emu::Display::Rows::value_type);
+	static constexpr std::size_t displayHeight = std::tuple_size_v<emu::Display::Rows>;
+
+	struct Frame
+	{
+		emu::Display::Rows rows {};
+		std::uint64_t cycles = 0;
+		// over the last second's batches
+		double cyclesPerSecond = 0.0;
+		// emulated time over wall-clock time
+		double speedMultiple = 0.0;
+		// how long batches take, in ns, since the rom was loaded
+		std::uint64_t batchLatencyP50 = 0;
+		std::uint64_t batchLatencyP99 = 0;
+		std::uint64_t batchLatencyP999 = 0;
+	};
+
+	// what the disassembler shows
+	struct Snapshot
+	{
+		emu::Cpu cpu {};
+		emu::Ram ram {};
+		emu::Keypad keypad {};
+		emu::Instruction::Enum lastExecutedInstructionCode = emu::Instruction::END;
+		emu::TwoBytes lastExecutedInstruction = 0x0;
+	};
+
+	EmulatorThread() : _thread([this] { run(); }) {}
+	~EmulatorThread()
+	{
+		_stop = true;
+		_thread.join();
+	}
+	EmulatorThread(const EmulatorThread&) = delete;
+	EmulatorThread& operator=(const EmulatorThread&) = delete;
+
+	// GUI thread only: false if the emulator is lagging behind by a whole queue of key events
+	bool PressKey(const emu::Keys::Enum key, const bool pressed) { return _keyEvents.TryPush(KeyEvent { key, pressed }); }
+	// GUI thread only: moves to the latest published frame, returning false if there's none since the last call
+	bool UpdateFrame() { return _frames.Update(); }
+	// GUI thread only
+	[[nodiscard]] const Frame& GetFrame() const { return _frames.GetFrontBuffer(); }
+
+	void SetRunning(const bool running) { _running = running; }
+	[[nodiscard]] bool IsRunning() const { return _running; }
+	// unthrottled, publishing a frame every frameSkip frames
+	void SetFastForward(const bool fastForward) { _fastForward = fastForward; }
+	void SetFrameSkip(const std::size_t frameSkip) { _frameSkip = frameSkip; }
+
+	// everything else waits for the end of the current batch, which lasts about a millisecond
+	bool LoadRom(const std::filesystem::path& path)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_cycles = 0;
+		_throughput.Clear();
+		_batchLatency.Clear();
+		return _emulator.LoadRom(path);
+	}
+	void Step()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_cycles += _emulator.RunCycles(1).cycles;
+	}
+	void Rewind()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_cycles > 0)
+			--_cycles;
+		_emulator.Rewind();
+	}
+	void Serialize(std::vector<emu::Byte>& byteArray)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_emulator.Serialize(byteArray);
+	}
+	void Deserialize(const utils::Span<emu::Byte>& byteArray)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_emulator.Deserialize(byteArray);
+	}
+	[[nodiscard]] std::size_t GetInstructionsPerSecond()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _emulator.GetInstructionsPerSecond();
+	}
+	void SetInstructionsPerSecond(const std::size_t instructionsPerSecond)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_emulator.SetInstructionsPerSecond(instructionsPerSecond);
+	}
+	// false unless built with CHIP8_PROFILER
+	bool TakeProfile(emu::Profile& profile)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_emulator.GetProfile())
+			return false;
+		profile = *_emulator.GetProfile();
+		return true;
+	}
+	void ResetProfile()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_emulator.ResetProfile();
+	}
+	void TakeSnapshot(Snapshot& snapshot)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		snapshot.cpu = _emulator.GetCpu();
+		snapshot.ram = _emulator.GetRam();
+		snapshot.keypad = _emulator.GetKeypad();
+		snapshot.lastExecutedInstructionCode = _emulator.GetLastExecutedInstructionCode();
+		snapshot.lastExecutedInstruction = _emulator.GetLastExecutedInstruction();
+	}
+
+private:
+	struct KeyEvent
+	{
+		emu::Keys::Enum key = emu::Keys::END;
+		bool pressed = false;
+	};
+
+	void run()
+	{
+		auto lastRunTime = std::chrono::steady_clock::now();
+		while (!_stop)
+		{
+			// the game speed follows the wall clock
+			const auto now = std::chrono::steady_clock::now();
+			const auto elapsed = now - std::exchange(lastRunTime, now);
+
+			const auto fastForward = _fastForward.load();
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+
+				KeyEvent keyEvent;
+				while (_keyEvents.TryPop(keyEvent))
+					_emulator.GetKeypad().Press(keyEvent.key, keyEvent.pressed);
+
+				if (_running)
+					runBatch(elapsed, fastForward);
+
+				// published even when paused, as the GUI may have stepped, rewound or loaded a state
+				auto& frame = _frames.GetBackBuffer();
+				std::copy(_emulator.GetDisplay().GetRows().begin(), _emulator.GetDisplay().GetRows().end(),
+						  frame.rows.begin());
+				frame.cycles = _cycles;
+				frame.cyclesPerSecond = _throughput.GetItemsPerSecond();
+				frame.speedMultiple = _speedMultiple;
+				frame.batchLatencyP50 = _batchLatency.GetPercentile(50.0);
+				frame.batchLatencyP99 = _batchLatency.GetPercentile(99.0);
+				frame.batchLatencyP999 = _batchLatency.GetPercentile(99.9);
+				_frames.Publish();
+			}
+
+			// std::mutex isn't fair: relocking straight away would starve the GUI's calls when fast forwarding
+			if (fastForward)
+				std::this_thread::yield();
+			else
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	// the cycles due since the last batch, or _frameSkip frames worth when fast forwarding
+	void runBatch(const std::chrono::steady_clock::duration elapsed, const bool fastForward)
+	{
+		utils::TscStopWatch sw;
+		const auto result = fastForward
+								? _emulator.RunCyclesThroughKeyWaits(_frameSkip * _emulator.GetCyclesPerFrame())
+								: _emulator.RunFor(elapsed);
+		sw.Stop();
+		if (result.cycles > 0)
+		{
+			_throughput.Add(result.cycles, sw.GetTicks());
+			_batchLatency.Record(static_cast<std::uint64_t>(sw.GetNanoSeconds()));
+		}
+
+		// smoothed over a few batches
+		const auto emulatedSeconds =
+			static_cast<double>(result.cycles) / static_cast<double>(_emulator.GetInstructionsPerSecond());
+		const auto elapsedSeconds = std::chrono::duration<double>(elapsed).count();
+		if (elapsedSeconds > 0.0)
+			_speedMultiple += 0.1 * (emulatedSeconds / elapsedSeconds - _speedMultiple);
+
+		_cycles += result.cycles;
+		if (_stopOnError && result.stopReason == emu::StopReason::Error)
+			_running = false;
+	}
+
+private:
+	// guards everything below but the atomics, the queue and the triple buffer
+	std::mutex _mutex {};
+	emu::Chip8 _emulator {};
+	std::uint64_t _cycles = 0;
+	utils::ThroughputMeter _throughput {};
+	utils::LatencyHistogram _batchLatency {};
+	double _speedMultiple = 0.0;
+	bool _stopOnError = true;
+
+	utils::SpscQueue<KeyEvent, 64> _keyEvents {};
+	utils::TripleBuffer<Frame> _frames {};
+
+	std::atomic<bool> _running = false;
+	std::atomic<bool> _fastForward = false;
+	std::atomic<std::size_t> _frameSkip = 10;
+	std::atomic<bool> _stop = false;
+
+	// last, so that it starts once everything else is initialized
+	std::thread _thread;
+};
+
 __START_IGNORING_WARNINGS__
 __IGNORE_WARNING__("-Wnon-virtual-dtor")
 __IGNORE_WARNING__("-Wold-style-cast")
@@ -292,24 +517,30 @@ class ChipEightEmulator: public mahi::gui::Application
 {
 public:
 	explicit ChipEightEmulator(const mahi::gui::Application::Config& config,
-							   std::shared_ptr<utils::RingBufferSinkSt> sink)
+							   std::shared_ptr<utils::AsyncRingBufferSink> sink)
 		: Application(config), _sink(std::move(sink))
 	{
 		spdlog::set_level(logLevel);
 		setFpsLimit();
 	}
-	virtual ~ChipEightEmulator() = default;
+	virtual ~ChipEightEmulator()
+	{
+		if (_screenTexture != 0)
+			glDeleteTextures(1, &_screenTexture);
+	}
 
 private:
 	// Override update (called once per frame)
 	void update() override 
 	{ 
+		_hasNewFrame = _emulatorThread.UpdateFrame();
 		setupMainWindow();
 		runEmulator();
 		drawEmulatorScreen();
 		
 		setUpDebuggingWindow();
 		setUpDisassemblerView();
+		setUpProfilerView();
 		setUpMenuBar();
 
 		if (!_open)
@@ -351,13 +582,17 @@ private:
 		ImGui::Separator();
 
 		if (ImGui::Button("Clear"))
-			_sink->GetRingBuffer().Clear();
+			_sink->Clear();
 		ImGui::SameLine();
 		_filter.Draw("Filter", -50);
+		if (_sink->GetDroppedCount() > 0 || _sink->GetTruncatedCount() > 0)
+			ImGui::Text("Dropped: %zu - Truncated: %zu", _sink->GetDroppedCount(), _sink->GetTruncatedCount());
+
+		// the emulator thread may be logging in the meantime
+		_sink->GetSnapshot(_logLines);
 		ImGui::BeginChild("scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
-		for (size_t i = 0; i < _sink->GetRingBuffer().Size(); ++i)
+		for (const auto& rbIter : _logLines)
 		{
-			const auto& rbIter = _sink->GetRingBuffer()[i];
 			if (_filter.PassFilter(rbIter.second.c_str()))
 			{
 				ImGui::PushStyleColor(ImGuiCol_Text, logColors.at(rbIter.first));
@@ -380,8 +615,9 @@ private:
 		ImGui::SetNextWindowPos({ 676, 38 }, ImGuiCond_FirstUseEver);
 		ImGui::Begin("Disassembler", &_viewDisassembler);
 
-		const auto& cpu = _emulator.GetCpu();
-		const auto& ram = _emulator.GetRam();
+		_emulatorThread.TakeSnapshot(_snapshot);
+		const auto& cpu = _snapshot.cpu;
+		const auto& ram = _snapshot.ram;
 		ImGui::Text("PC=0x%04X", cpu.GetProgramCounter());
 		ImGui::SameLine();
 		ImGui::Text("I=0x%04X", cpu.GetIndexRegister());
@@ -393,9 +629,9 @@ private:
 		ImGui::Text("Current Instruction=0x%02X%02X", ram.GetAt(cpu.GetProgramCounter()),
 					ram.GetAt(cpu.GetProgramCounter() + 1));
 		//		ImGui::SameLine();
-		ImGui::Text("Last Instruction=%s|%s|0x%04X", emu::ToString(_emulator.GetLastExecutedInstructionCode()).data(),
-					emu::cpuInstructionMapping[_emulator.GetLastExecutedInstructionCode()].data(),
-					_emulator.GetLastExecutedInstruction());
+		ImGui::Text("Last Instruction=%s|%s|0x%04X", emu::ToString(_snapshot.lastExecutedInstructionCode).data(),
+					emu::cpuInstructionMapping[_snapshot.lastExecutedInstructionCode].data(),
+					_snapshot.lastExecutedInstruction);
 		ImGui::Separator();
 
 		ImGui::BeginGroup();
@@ -434,7 +670,7 @@ private:
 			//
 			ImGui::SameLine();
 
-			bool isKeyPressed = _emulator.GetKeypad().IsPressed(static_cast<emu::Keys::Enum>(k));
+			bool isKeyPressed = _snapshot.keypad.IsPressed(static_cast<emu::Keys::Enum>(k));
 			ImGui::Checkbox("", &isKeyPressed);
 			//			if (pressedKeys[k])
 			//				_emulator.GetKeypad().Press(static_cast<emu::Keys::Enum>(k), true);
@@ -479,6 +715,123 @@ private:
 		ImGui::End();
 	}
 
+	void setUpProfilerView()
+	{
+		if (!_viewProfiler)
+			return;
+
+		ImGui::SetNextWindowSize({ 640, 480 }, ImGuiCond_FirstUseEver);
+		ImGui::SetNextWindowPos({ 996, 38 }, ImGuiCond_FirstUseEver);
+		ImGui::Begin("Profiler", &_viewProfiler);
+		if (!_emulatorThread.TakeProfile(_profile))
+		{
+			ImGui::TextUnformatted("Not available: build with -DCHIP8_PROFILER=ON");
+			ImGui::End();
+			return;
+		}
+
+		if (ImGui::Button("Reset"))
+			_emulatorThread.ResetProfile();
+		const auto total = _profile.GetTotal();
+		ImGui::SameLine();
+		ImGui::Text("Instructions=%llu Host Cycles=%llu", static_cast<unsigned long long>(total.count),
+					static_cast<unsigned long long>(total.hostCycles));
+		ImGui::Separator();
+
+		_profileRows.clear();
+		for (auto code = emu::Instruction::START; code <= emu::Instruction::END;
+			 code = static_cast<emu::Instruction::Enum>(code + 1))
+		{
+			if (_profile.instructions[code].count > 0)
+				_profileRows.push_back(code);
+		}
+		const auto getHostCyclesPerInstruction = [&](const emu::Instruction::Enum code)
+		{
+			const auto& instruction = _profile.instructions[code];
+			return static_cast<double>(instruction.hostCycles) / static_cast<double>(instruction.count);
+		};
+		std::stable_sort(_profileRows.begin(), _profileRows.end(),
+						 [&](auto lhs, auto rhs)
+						 {
+							 if (!_profileSortDescending)
+								 std::swap(lhs, rhs);
+							 switch (_profileSortColumn)
+							 {
+								 case ProfileColumn::Instruction:
+									 return lhs > rhs;
+								 case ProfileColumn::Method:
+									 return emu::cpuInstructionMapping[lhs] > emu::cpuInstructionMapping[rhs];
+								 case ProfileColumn::Count:
+									 return _profile.instructions[lhs].count > _profile.instructions[rhs].count;
+								 case ProfileColumn::HostCyclesPerInstruction:
+									 return getHostCyclesPerInstruction(lhs) > getHostCyclesPerInstruction(rhs);
+								 default:
+									 return _profile.instructions[lhs].hostCycles > _profile.instructions[rhs].hostCycles;
+							 }
+						 });
+
+		// clicking on a header sorts by that column, clicking again reverses the order
+		static constexpr std::array<const char*, ProfileColumn::END> headers = {
+			"Instruction", "Method", "Count", "Host Cycles", "Host Cycles/Instruction",
+		};
+		ImGui::Columns(static_cast<int>(headers.size()), "profile");
+		for (std::size_t column = 0; column < headers.size(); ++column)
+		{
+			const auto isSortColumn = static_cast<ProfileColumn::Enum>(column) == _profileSortColumn;
+			if (ImGui::Selectable(headers[column], isSortColumn))
+			{
+				_profileSortDescending = !isSortColumn || !_profileSortDescending;
+				_profileSortColumn = static_cast<ProfileColumn::Enum>(column);
+			}
+			ImGui::NextColumn();
+		}
+		ImGui::Separator();
+
+		const auto getShare = [](const std::uint64_t value, const std::uint64_t valueTotal)
+		{ return valueTotal > 0 ? 100.0 * static_cast<double>(value) / static_cast<double>(valueTotal) : 0.0; };
+		for (const auto code : _profileRows)
+		{
+			const auto& instruction = _profile.instructions[code];
+			ImGui::TextUnformatted(emu::ToString(code).data());
+			ImGui::NextColumn();
+			ImGui::TextUnformatted(emu::cpuInstructionMapping[code].data());
+			ImGui::NextColumn();
+			ImGui::Text("%llu (%.1f%%)", static_cast<unsigned long long>(instruction.count),
+						getShare(instruction.count, total.count));
+			ImGui::NextColumn();
+			ImGui::Text("%llu (%.1f%%)", static_cast<unsigned long long>(instruction.hostCycles),
+						getShare(instruction.hostCycles, total.hostCycles));
+			ImGui::NextColumn();
+			ImGui::Text("%.1f", getHostCyclesPerInstruction(code));
+			ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+		ImGui::Separator();
+
+		// where the guest spends its time
+		static constexpr std::size_t nHottestAddresses = 16;
+		_hottestAddresses.clear();
+		for (std::size_t address = 0; address < _profile.programCounterHits.size(); ++address)
+		{
+			if (_profile.programCounterHits[address] > 0)
+				_hottestAddresses.push_back(address);
+		}
+		const auto nShown = std::min(nHottestAddresses, _hottestAddresses.size());
+		std::partial_sort(_hottestAddresses.begin(), _hottestAddresses.begin() + static_cast<std::ptrdiff_t>(nShown),
+						  _hottestAddresses.end(), [&](const auto lhs, const auto rhs)
+						  { return _profile.programCounterHits[lhs] > _profile.programCounterHits[rhs]; });
+		ImGui::BeginGroupPanel("Hottest Addresses", ImVec2(0.0f, 0.0f));
+		for (std::size_t i = 0; i < nShown; ++i)
+		{
+			const auto hits = _profile.programCounterHits[_hottestAddresses[i]];
+			ImGui::Text("0x%03zX: %llu (%.1f%%)", _hottestAddresses[i], static_cast<unsigned long long>(hits),
+						getShare(hits, total.count));
+		}
+		ImGui::EndGroupPanel();
+
+		ImGui::End();
+	}
+
 	void setUpMenuBar()
 	{
 		if (ImGui::BeginMainMenuBar())
@@ -490,8 +843,8 @@ private:
 					if (mahi::gui::open_dialog(_selectedRom, { { "Chip8 Roms", "ch8" } }) ==
 						mahi::gui::DialogResult::DialogOkay)
 					{
-						_emulator.LoadRom(_selectedRom);
-						_running = true;
+						_emulatorThread.LoadRom(_selectedRom);
+						_emulatorThread.SetRunning(true);
 					}
 				}
 
@@ -521,7 +874,7 @@ private:
 								saveStateFile.seekg(saveStateFile.beg);
 								saveStateFile.read(reinterpret_cast<char*>(byteArray.data()),
 												   static_cast<long>(fileSize));
-								_emulator.Deserialize(byteArray);
+								_emulatorThread.Deserialize(byteArray);
 
 								_saveStateOperation = SaveStateOperation::Load;
 							}
@@ -540,7 +893,7 @@ private:
 							std::filesystem::path saveState = _selectedRom + ".sav." + std::to_string(i);
 
 							std::vector<emu::Byte> byteArray;
-							_emulator.Serialize(byteArray);
+							_emulatorThread.Serialize(byteArray);
 							std::ofstream saveStateFile(saveState.string(), std::ios::binary);
 							saveStateFile.write(reinterpret_cast<const char*>(&byteArray[0]),
 												static_cast<long>(byteArray.size() * sizeof(emu::Byte)));
@@ -562,8 +915,8 @@ private:
 			{
 				if (ImGui::MenuItem("Restart"))
 				{
-					_emulator.LoadRom(_selectedRom);
-					_running = true;
+					_emulatorThread.LoadRom(_selectedRom);
+					_emulatorThread.SetRunning(true);
 				}
 				ImGui::MenuItem("Cap FPS", nullptr, &_capFps);
 
@@ -573,10 +926,17 @@ private:
 				if (changed)
 					_capFps = true;
 
-				if (_capFps)
-					set_frame_limit(mahi::util::hertz(static_cast<long long int>(_fps)));
-				else
-					set_frame_limit(mahi::util::hertz(0));
+				setFpsLimit();
+
+				auto instructionsPerSecond = static_cast<int>(_emulatorThread.GetInstructionsPerSecond());
+				if (ImGui::SliderInt("Speed", &instructionsPerSecond, static_cast<int>(emu::Chip8::timerFrequency), 5000,
+									 "%d Hz"))
+					_emulatorThread.SetInstructionsPerSecond(static_cast<std::size_t>(instructionsPerSecond));
+
+				if (ImGui::MenuItem("Fast Forward", nullptr, &_fastForward))
+					_emulatorThread.SetFastForward(_fastForward);
+				if (ImGui::SliderInt("Frame Skip", &_frameSkip, 1, 1000))
+					_emulatorThread.SetFrameSkip(static_cast<std::size_t>(_frameSkip));
 				ImGui::EndMenu();
 			}
 
@@ -596,6 +956,7 @@ private:
 			if (ImGui::BeginMenu("Debug"))
 			{
 				ImGui::MenuItem("View Disassembler", nullptr, &_viewDisassembler);
+				ImGui::MenuItem("View Profiler", nullptr, &_viewProfiler);
 				ImGui::MenuItem("View Logging", nullptr, &_viewLogging);
 
 				ImGui::EndMenu();
@@ -642,8 +1003,8 @@ private:
 
 	void setupMainWindow()
 	{
-		const auto xDim = 2.0f * _xPadding + static_cast<float>(_emulator.GetDisplay().GetWidth()) * _pixelSize;
-		const auto yDim = 2.0f * _yPadding + static_cast<float>(_emulator.GetDisplay().GetHeight()) * _pixelSize;
+		const auto xDim = 2.0f * _xPadding + static_cast<float>(EmulatorThread::displayWidth) * _pixelSize;
+		const auto yDim = 2.0f * _yPadding + static_cast<float>(EmulatorThread::displayHeight) * _pixelSize;
 		ImGui::SetNextWindowSize(ImVec2(20 + xDim, 120 + yDim), ImGuiCond_Always);
 		ImGui::SetNextWindowPos({ 82, 31 }, ImGuiCond_FirstUseEver);
 		ImGui::Begin("Display", &_open, ImGuiWindowFlags_NoResize);
@@ -652,64 +1013,60 @@ private:
 			ImGui::Text("%.2f FPS", static_cast<double>(ImGui::GetIO().Framerate));
 		//		ImGui::SameLine();
 
+		const auto& frame = _emulatorThread.GetFrame();
 		if (_viewCycles)
-			ImGui::Text("%lu Cycles", _cycles);
+			ImGui::Text("%lu Cycles", frame.cycles);
 
 		if (_viewPerformance)
 		{
-			if (_cyclesPerSeconds > 1e9)
-				ImGui::Text("%.2f GHz", _cyclesPerSeconds * 1e-9);
-			else if (_cyclesPerSeconds > 1e6)
-				ImGui::Text("%.2f MHz", _cyclesPerSeconds * 1e-6);
-			else if (_cyclesPerSeconds > 1e3)
-				ImGui::Text("%.2f KHz", _cyclesPerSeconds * 1e-3);
+			if (frame.cyclesPerSecond > 1e9)
+				ImGui::Text("%.2f GHz", frame.cyclesPerSecond * 1e-9);
+			else if (frame.cyclesPerSecond > 1e6)
+				ImGui::Text("%.2f MHz", frame.cyclesPerSecond * 1e-6);
+			else if (frame.cyclesPerSecond > 1e3)
+				ImGui::Text("%.2f KHz", frame.cyclesPerSecond * 1e-3);
 			else
-				ImGui::Text("%.2f Hz", _cyclesPerSeconds);
+				ImGui::Text("%.2f Hz", frame.cyclesPerSecond);
+			ImGui::Text("x%.1f speed", frame.speedMultiple);
+			ImGui::Text("batch p50 %.1fus p99 %.1fus p99.9 %.1fus", static_cast<double>(frame.batchLatencyP50) * 1e-3,
+						static_cast<double>(frame.batchLatencyP99) * 1e-3,
+						static_cast<double>(frame.batchLatencyP999) * 1e-3);
 		}
 
 		if (ImGui::Button("Play"))
-			_running = true;
+			_emulatorThread.SetRunning(true);
 		ImGui::SameLine();
 		if (ImGui::Button("Stop"))
-			_running = false;
+			_emulatorThread.SetRunning(false);
 		ImGui::SameLine();
 		_stepping = ImGui::Button("Step");
 		ImGui::SameLine();
 		_rewinding = ImGui::Button("Rewind");
 		if (_stepping || _rewinding)
-			_running = false;
+			_emulatorThread.SetRunning(false);
+		ImGui::SameLine();
+		if (ImGui::Checkbox("Fast Forward", &_fastForward))
+			_emulatorThread.SetFastForward(_fastForward);
 	}
 
+	// the emulation itself runs on _emulatorThread
 	void runEmulator()
 	{
 		if (_rewinding)
-		{
-			if (_cycles > 0)
-				--_cycles;
-			_emulator.Rewind();
-		}
-		else if (_running || _stepping)
-		{
-			const auto pressedKeys = GetKeysPressed();
-			const auto releasedKeys = GetKeysReleased();
-			for (size_t k = emu::Keys::START; k < emu::Keys::END; ++k)
-			{
-				if (pressedKeys[k])
-					_emulator.GetKeypad().Press(static_cast<emu::Keys::Enum>(k), true);
-				else if (releasedKeys[k])
-					_emulator.GetKeypad().Press(static_cast<emu::Keys::Enum>(k), false);
-			}
+			_emulatorThread.Rewind();
+		else if (_stepping)
+			_emulatorThread.Step();
 
-			utils::StopWatch sw;
-			bool success = _emulator.Cycle();
-			sw.Stop();
-			_cyclesPerSeconds = 1.0 / sw.GetSeconds();
-
-			++_cycles;
-			if (_stopOnError && !success)
-			{
-				_running = false;
-			}
+		// only what has changed since the last frame
+		const auto pressedKeys = GetKeysPressed();
+		const auto releasedKeys = GetKeysReleased();
+		for (size_t k = emu::Keys::START; k < emu::Keys::END; ++k)
+		{
+			const bool isPressed = pressedKeys[k] || (_pressedKeys[k] && !releasedKeys[k]);
+			if (isPressed == _pressedKeys[k])
+				continue;
+			if (_emulatorThread.PressKey(static_cast<emu::Keys::Enum>(k), isPressed))
+				_pressedKeys[k] = isPressed;
 		}
 	}
 
@@ -720,38 +1077,95 @@ private:
 		auto p = ImGui::GetCursorScreenPos();
 		drawList->AddRect(
 			p,
-			{ p.x + 2.0f * _xPadding + static_cast<float>(_emulator.GetDisplay().GetWidth()) * _pixelSize,
-			  p.y + 2.0f * _yPadding + static_cast<float>(_emulator.GetDisplay().GetHeight()) * _pixelSize },
+			{ p.x + 2.0f * _xPadding + static_cast<float>(EmulatorThread::displayWidth) * _pixelSize,
+			  p.y + 2.0f * _yPadding + static_cast<float>(EmulatorThread::displayHeight) * _pixelSize },
 			Convert(_frameColor));
 		p.x += _xPadding;
 		p.y += _yPadding;
 
-		for (size_t row = 0; row < _emulator.GetDisplay().GetWidth(); ++row)
+		// a single quad: the texture is white where pixels are on, and the pixel colour is applied as a tint
+		updateScreenTexture();
+		drawList->AddImage(reinterpret_cast<ImTextureID>(static_cast<std::uintptr_t>(_screenTexture)), p,
+						   { p.x + static_cast<float>(EmulatorThread::displayWidth) * _pixelSize,
+							 p.y + static_cast<float>(EmulatorThread::displayHeight) * _pixelSize },
+						   { 0.0f, 0.0f }, { 1.0f, 1.0f }, Convert(_pixelColor));
+	}
+
+	// expands and uploads only the rows that have changed since the last upload, if there's a new frame at all
+	void updateScreenTexture()
+	{
+		if (_screenTexture == 0)
 		{
-			auto pixelStart = p;
-			pixelStart.x = p.x + static_cast<float>(row) * _pixelSize;
+			glGenTextures(1, &_screenTexture);
+			glBindTexture(GL_TEXTURE_2D, _screenTexture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			// blank, as _uploadedRows
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, EmulatorThread::displayWidth, EmulatorThread::displayHeight, 0,
+						 GL_RGBA, GL_UNSIGNED_BYTE, _screenPixels.data());
+		}
+		if (!_hasNewFrame)
+			return;
 
-			for (size_t col = 0; col < _emulator.GetDisplay().GetHeight(); ++col)
-			{
-				pixelStart.y = p.y + static_cast<float>(col) * _pixelSize;
-				ImVec2 pixelEnd = { pixelStart.x + _pixelSize, pixelStart.y + _pixelSize };
-				const size_t coord = row + col * _emulator.GetDisplay().GetWidth();
-				if (_emulator.GetDisplay().GetAt(coord))
-					drawList->AddRectFilled(pixelStart, pixelEnd, Convert(_pixelColor));
-			}
+		const auto& rows = _emulatorThread.GetFrame().rows;
+		std::size_t firstDirtyRow = rows.size();
+		std::size_t lastDirtyRow = 0;
+		for (std::size_t y = 0; y < rows.size(); ++y)
+		{
+			if (rows[y] == _uploadedRows[y])
+				continue;
+
+			utils::ExpandBits(rows[y], &_screenPixels[y * EmulatorThread::displayWidth]);
+			_uploadedRows[y] = rows[y];
+			firstDirtyRow = std::min(firstDirtyRow, y);
+			lastDirtyRow = y;
 		}
+		if (firstDirtyRow > lastDirtyRow)
+			return;
+
+		glBindTexture(GL_TEXTURE_2D, _screenTexture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLint>(firstDirtyRow), EmulatorThread::displayWidth,
+						static_cast<GLsizei>(lastDirtyRow - firstDirtyRow + 1), GL_RGBA, GL_UNSIGNED_BYTE,
+						&_screenPixels[firstDirtyRow * EmulatorThread::displayWidth]);
 	}
 
 private:
-	emu::Chip8 _emulator {};
+	EmulatorThread _emulatorThread {};
+	EmulatorThread::Snapshot _snapshot {};
+
+	struct ProfileColumn
+	{
+		enum Enum
+		{
+			Instruction,
+			Method,
+			Count,
+			HostCycles,
+			HostCyclesPerInstruction,
+			END,
+		};
+	};
+	emu::Profile _profile {};
+	std::vector<emu::Instruction::Enum> _profileRows {};
+	std::vector<std::size_t> _hottestAddresses {};
+	ProfileColumn::Enum _profileSortColumn = ProfileColumn::HostCycles;
+	bool _profileSortDescending = true;
+	bool _hasNewFrame = false;
+
+	// RGBA, as a mask
+	GLuint _screenTexture = 0;
+	std::array<std::uint32_t, EmulatorThread::displayWidth * EmulatorThread::displayHeight> _screenPixels {};
+	emu::Display::Rows _uploadedRows {};
+	std::bitset<emu::Keys::END> _pressedKeys {};
 	std::string _selectedRom {};
 
 	spdlog::level::level_enum logLevel = spdlog::level::warn;
-	std::shared_ptr<utils::RingBufferSinkSt> _sink {};
+	std::shared_ptr<utils::AsyncRingBufferSink> _sink {};
+	std::vector<utils::AsyncRingBufferSink::Line> _logLines {};
 	ImGuiTextFilter _filter {};
 
-	bool _stopOnError = true;
-
 	bool _open = true;
 	mahi::gui::Color _pixelColor { mahi::gui::Colors::Red };
 	mahi::gui::Color _frameColor {{{ 1.0f, 1.0f, 1.0f, 0.1f }}};
@@ -764,17 +1178,17 @@ private:
 	std::chrono::system_clock::time_point _saveStateTimer {};
 	SaveStateOperation _saveStateOperation = SaveStateOperation::None;
 
-	bool _running = false;
 	bool _rewinding = false;
 	bool _stepping = false;
 	bool _capFps = true;
 	float _fps = 60.0f;
-	std::uint64_t _cycles = 0;
-	double _cyclesPerSeconds = 0.0;
+	bool _fastForward = false;
+	int _frameSkip = 10;
 	bool _viewFps = true;
 	bool _viewCycles = true;
 	bool _viewPerformance = true;
 	bool _viewDisassembler = false;
+	bool _viewProfiler = false;
 	bool _viewLogging = false;
 };
 